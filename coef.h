@@ -2,6 +2,11 @@
 #define FILTER_FREQUENCY_COUNT 10
 #define IIR_A_COEFFICIENT_COUNT 11
 #define IIR_B_COEFFICIENT_COUNT 11
+#define CIC_COMPENSATOR_TAP_COUNT 15
+#define HALF_BAND_TAP_COUNT 11
+#define HALF_BAND_SECOND_STAGE_TAP_COUNT 31
+#define IIR_PARALLEL_SECTION_COUNT 5
+#define IIR_PARALLEL_COEFFICIENT_COUNT 4
 
 
 
@@ -112,4 +117,141 @@ const static double iirBCoefficientConstants[FILTER_FREQUENCY_COUNT][IIR_B_COEFF
 {9.0928661148195069e-10, 0.0000000000000000e+00, -4.5464330574097538e-09, 0.0000000000000000e+00, 9.0928661148195076e-09, 0.0000000000000000e+00, -9.0928661148195076e-09, 0.0000000000000000e+00, 4.5464330574097538e-09, 0.0000000000000000e+00, -9.0928661148195069e-10},
 {9.0928661148190954e-10, 0.0000000000000000e+00, -4.5464330574095478e-09, 0.0000000000000000e+00, 9.0928661148190956e-09, 0.0000000000000000e+00, -9.0928661148190956e-09, 0.0000000000000000e+00, 4.5464330574095478e-09, 0.0000000000000000e+00, -9.0928661148190954e-10},
 {9.0928661148206091e-10, 0.0000000000000000e+00, -4.5464330574103047e-09, 0.0000000000000000e+00, 9.0928661148206094e-09, 0.0000000000000000e+00, -9.0928661148206094e-09, 0.0000000000000000e+00, 4.5464330574103047e-09, 0.0000000000000000e+00, -9.0928661148206091e-10}
+};
+
+// FIR tables of the CIC and half-band decimators in multistageDecimator.c,
+// designed and written by milestone_1/generator/decimatorDesign.py
+const static double cicCompensatorCoefficients[CIC_COMPENSATOR_TAP_COUNT] = {
+4.5841080812307734e-02, 
+-6.4148609659249914e-02, 
+7.9183160383449469e-02, 
+-8.5085478686001914e-02, 
+7.0517573280570456e-02, 
+-8.7600183885969147e-03, 
+-1.8320597096419558e-01, 
+8.2762647805150591e-01, 
+-1.8320597096419558e-01, 
+-8.7600183885969147e-03, 
+7.0517573280570456e-02, 
+-8.5085478686001914e-02, 
+7.9183160383449469e-02, 
+-6.4148609659249914e-02, 
+4.5841080812307734e-02};
+
+const static double halfBandCoefficients[HALF_BAND_TAP_COUNT] = {
+5.0280918029840639e-03, 
+0.0000000000000000e+00, 
+-4.1675777043076012e-02, 
+0.0000000000000000e+00, 
+2.8664768524009193e-01, 
+5.0000000000000000e-01, 
+2.8664768524009193e-01, 
+0.0000000000000000e+00, 
+-4.1675777043076012e-02, 
+0.0000000000000000e+00, 
+5.0280918029840639e-03};
+
+const static double halfBandSecondStageCoefficients[HALF_BAND_SECOND_STAGE_TAP_COUNT] = {
+-1.1291110041242775e-02, 
+1.0350739168851019e-02, 
+1.1542742622107745e-02, 
+1.2198976045794402e-02, 
+9.7371038883605626e-03, 
+3.1943390149640149e-03, 
+-6.2395882028296202e-03, 
+-1.5449270651578192e-02, 
+-2.0251807389659829e-02, 
+-1.6723140716133757e-02, 
+-2.9141629247479372e-03, 
+2.0182772026300009e-02, 
+4.8566832662510405e-02, 
+7.5985644270683134e-02, 
+9.5849989385501502e-02, 
+1.0309767322227989e-01, 
+9.5849989385501502e-02, 
+7.5985644270683134e-02, 
+4.8566832662510405e-02, 
+2.0182772026300009e-02, 
+-2.9141629247479372e-03, 
+-1.6723140716133757e-02, 
+-2.0251807389659829e-02, 
+-1.5449270651578192e-02, 
+-6.2395882028296202e-03, 
+3.1943390149640149e-03, 
+9.7371038883605626e-03, 
+1.2198976045794402e-02, 
+1.1542742622107745e-02, 
+1.0350739168851019e-02, 
+-1.1291110041242775e-02};
+
+// parallel form of the IIR filters above: H(z) = d + sum of
+// (b0 + b1 z^-1) / (1 + a1 z^-1 + a2 z^-2) over the sections, {b0, b1, a1, a2}
+// per section. Each section is one conjugate pole pair from the roots of
+// iirACoefficientConstants with its partial fraction residue, computed in
+// 50 digit precision so the residues of the clustered poles stay accurate.
+// Written by milestone_1/generator/parallelSections.py, which has to be run
+// again whenever the IIR rows above change
+const static double iirParallelDirectTerms[FILTER_FREQUENCY_COUNT] = {
+-1.0065959698601960e-09, 
+-1.0065959698599679e-09, 
+-1.0065959698601581e-09, 
+-1.0065959698600308e-09, 
+-1.0065959698603784e-09, 
+-1.0065959698600210e-09, 
+-1.0065959698601797e-09, 
+-1.0065959698601968e-09, 
+-1.0065959698601495e-09, 
+-1.0065959698603207e-09};
+
+const static double iirParallelSections[FILTER_FREQUENCY_COUNT][IIR_PARALLEL_SECTION_COUNT][IIR_PARALLEL_COEFFICIENT_COUNT] = {
+{{-2.5586740156805378e-02, -1.1584807718083642e-02, -1.2044435400423461e+00, 9.7507576093710258e-01},
+ {-4.2412219896517259e-03, 1.2979450921994901e-02, -1.2227163514322850e+00, 9.9044859780982941e-01},
+ {5.9535060369155582e-02, -3.5869847134994082e-02, -1.1863680536418379e+00, 9.6906745399374883e-01},
+ {-2.5270115996901633e-02, 4.2989600430044995e-02, -1.1751239611142095e+00, 9.7473021864809672e-01},
+ {-4.4369803099142619e-03, -8.2317827374287309e-03, -1.1751208007857232e+00, 9.9023179938038630e-01}},
+{{-2.5539385021422906e-02, -1.8045697812748587e-02, -9.4141681092056551e-01, 9.7502437041167322e-01},
+ {5.9534627451402630e-02, -2.7894564753855804e-02, -9.2259236846754722e-01, 9.6906739869414049e-01},
+ {-4.2703778111550282e-03, 1.3617282920592550e-02, -9.5865684052198485e-01, 9.9041636415227929e-01},
+ {-2.5316959919284704e-02, 4.2467947629880605e-02, -9.0908057942127818e-01, 9.7478164107897225e-01},
+ {-4.4079027836574141e-03, -9.9251948228303351e-03, -9.0604811257577478e-01, 9.9026403537809393e-01}},
+{{5.9534775977891911e-02, -1.8399562714320392e-02, -6.0855036576965493e-01, 9.6906741764761450e-01},
+ {-2.5496406081544729e-02, -2.4551884639916286e-02, -6.2766922291929550e-01, 9.7497735457889489e-01},
+ {-4.2969932139523418e-03, 1.3910504615515054e-02, -6.4328086637104032e-01, 9.9038686513490304e-01},
+ {-2.5360114314123543e-02, 4.0661081030227628e-02, -5.9293576904039225e-01, 9.7482863126587349e-01},
+ {-4.3812604523887216e-03, -1.1475177326173466e-02, -5.8669556747471430e-01, 9.9029352783352920e-01}},
+{{5.9534724396950289e-02, -8.4636139301646259e-03, -2.7992805677575250e-01, 9.6906741100885185e-01},
+ {-2.5458350550307214e-02, -3.0248972353057700e-02, -2.9878981496179363e-01, 9.7493586019042233e-01},
+ {-2.5398109111844792e-02, 3.7659030247450619e-02, -2.6267822297153737e-01, 9.7487012688366570e-01},
+ {-4.3205089679647099e-03, 1.3781273612351356e-02, -3.1232391260939280e-01, 9.9036082125882841e-01},
+ {-4.3577538509509892e-03, -1.2661037608660433e-02, -2.5345491128120218e-01, 9.9031957083940547e-01}},
+{{5.9534769919190503e-02, 4.9326500494170341e-03, 1.6314356674274078e-01, 9.6906741681284769e-01},
+ {-2.5445692423475469e-02, 3.2027949364113427e-02, 1.8178847253561242e-01, 9.7492201586921212e-01},
+ {-2.5410821032391177e-02, -3.6346583216192184e-02, 1.4543810026854168e-01, 9.7488396551849121e-01},
+ {-4.3283473458807734e-03, -1.3639035263254461e-02, 1.9450173415266292e-01, 9.9035213512357900e-01},
+ {-4.3499072015605053e-03, 1.2986157654019241e-02, 1.3523718747804916e-01, 9.9032825578565731e-01}},
+{{5.9534842787601579e-02, 1.6288126342282550e-02, 5.3871734359758472e-01, 9.6906742612828511e-01},
+ {-2.5487953533366147e-02, 2.5851421992908755e-02, 5.5782689042411948e-01, 9.7496808152165537e-01},
+ {-2.5368645943487284e-02, -4.0112002270031859e-02, 5.2270990741249856e-01, 9.7483789584404401e-01},
+ {-4.3022391066851245e-03, -1.3917906021372935e-02, 5.7302693232585244e-01, 9.9038104344511657e-01},
+ {-4.3760022881804391e-03, 1.1762034688757710e-02, 5.1580591185539604e-01, 9.9029934760858573e-01}},
+{{-2.5549445349319622e-02, 1.6625524026032859e-02, 1.0029929326032614e+00, 9.7503506148826757e-01},
+ {5.9535039483985336e-02, 2.9760415949717674e-02, 9.8429798222826936e-01, 9.6906745130068861e-01},
+ {-4.2642715688202080e-03, -1.3503995942666125e-02, 1.0205053431464843e+00, 9.9042308116575783e-01},
+ {-2.5307386231846349e-02, -4.2681422008097797e-02, 9.7127092561646777e-01, 9.7477090775194741e-01},
+ {-4.4139344181165730e-03, 9.5650060359580621e-03, 9.6891634141310645e-01, 9.9025731143091922e-01}},
+{{-2.5595284166815276e-02, 1.0477848074686835e-02, 1.2453387797347979e+00, 9.7508547071677643e-01},
+ {-4.2357893665572978e-03, -1.2840264983437219e-02, 1.2637381569387276e+00, 9.9045467496772543e-01},
+ {5.9534530945165753e-02, 3.7111062288344210e-02, 1.2274302843810982e+00, 9.6906738538910309e-01},
+ {-2.5260950262645496e-02, -4.2969263374688996e-02, 1.2165897672409791e+00, 9.7472057331442041e-01},
+ {-4.4425052332650993e-03, 7.9282173136719595e-03, 1.2170923469323820e+00, 9.9022573181520290e-01}},
+{{-2.5664832503833460e-02, 3.0668162352620733e-03, 1.4904550497632048e+00, 9.7516145351348149e-01},
+ {-4.1927849037673411e-03, -1.1702375054605307e-02, 1.5093567322570565e+00, 9.9050227580027939e-01},
+ {5.9534516943680151e-02, 4.4563318117740169e-02, 1.4739237851040454e+00, 9.6906738093778921e-01},
+ {-2.5191394806379223e-02, -4.2082739004631602e-02, 1.4658797577263429e+00, 9.7464463440970039e-01},
+ {-4.4855028138175417e-03, 5.8038348197456333e-03, 1.4696759621565902e+00, 9.9017813912944119e-01}},
+{{-4.1136388828340630e-03, -9.9002293863958337e-03, 1.7387999199512272e+00, 9.9058872006739429e-01},
+ {-2.5795195870027553e-02, -5.7435178784502397e-03, 1.7200485666132506e+00, 9.7530053925086435e-01},
+ {5.9539089516469995e-02, 5.1569306078982365e-02, 1.7056801949586662e+00, 9.6906793149906278e-01},
+ {-2.5066549943996954e-02, -3.9406149637351465e-02, 1.7011303599918646e+00, 9.7450524093785840e-01},
+ {-4.5637029037288428e-03, 3.0742199105772998e-03, 1.7086465361197607e+00, 9.9009157587586893e-01}}
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "blockEnergy.h"
+
+#include <math.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+#define INDEX_OFFSET 1
+
+// Clears the energy.
+void blockEnergy_init(blockEnergy_t *energy) {
+  for (uint16_t b = FOR_LOOP_START_VALUE; b < BLOCK_ENERGY_BLOCK_COUNT; b++) {
+    energy->blockSums[b] = INITIAL_VALUE;
+  }
+  energy->oldestBlock = FOR_LOOP_START_VALUE;
+  energy->completedSum = INITIAL_VALUE;
+  energy->currentSum = INITIAL_VALUE;
+  energy->currentCount = FOR_LOOP_START_VALUE;
+}
+
+// Adds the square of the newest sample.
+void blockEnergy_addSquare(blockEnergy_t *energy, double square) {
+  energy->currentSum = energy->currentSum + square;
+  energy->currentCount++;
+
+  // case the block is full, so it replaces the oldest block and the window
+  // sum is taken again from the 20 block sums, so rounding never builds up
+  if (energy->currentCount >= BLOCK_ENERGY_BLOCK_LENGTH) {
+    energy->blockSums[energy->oldestBlock] = energy->currentSum;
+    energy->oldestBlock = (energy->oldestBlock + INDEX_OFFSET) %
+                          BLOCK_ENERGY_BLOCK_COUNT;
+    energy->completedSum = INITIAL_VALUE;
+    for (uint16_t b = FOR_LOOP_START_VALUE; b < BLOCK_ENERGY_BLOCK_COUNT;
+         b++) {
+      energy->completedSum = energy->completedSum + energy->blockSums[b];
+    }
+    energy->currentSum = INITIAL_VALUE;
+    energy->currentCount = FOR_LOOP_START_VALUE;
+  }
+}
+
+// Returns the estimated energy of the last 2000 samples.
+double blockEnergy_getPower(const blockEnergy_t *energy) {
+  // the first currentCount samples of the oldest block have left the window,
+  // and are taken to hold the same share of its sum
+  double leftFraction =
+      (double)energy->currentCount / BLOCK_ENERGY_BLOCK_LENGTH;
+  return energy->completedSum -
+         leftFraction * energy->blockSums[energy->oldestBlock] +
+         energy->currentSum;
+}
+
+// Returns the largest amount blockEnergy_getPower can be off by right now.
+double blockEnergy_getErrorBound(const blockEnergy_t *energy) {
+  // case the window ends on a block boundary, so the power is exact
+  if (energy->currentCount == FOR_LOOP_START_VALUE) {
+    return INITIAL_VALUE;
+  }
+  // the squares that left can hold anywhere from none to all of the oldest
+  // block's sum, so the estimate is off by at most the larger share
+  double leftFraction =
+      (double)energy->currentCount / BLOCK_ENERGY_BLOCK_LENGTH;
+  return fmax(leftFraction, 1.0 - leftFraction) *
+         energy->blockSums[energy->oldestBlock];
+}
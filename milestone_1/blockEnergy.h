@@ -0,0 +1,39 @@
+#ifndef BLOCKENERGY_H_
+#define BLOCKENERGY_H_
+
+#include <stdint.h>
+
+// Sliding energy over the last 2000 samples of one signal, kept as 20 sums of
+// 100 squares plus the running sum of the block being filled, instead of the
+// 2000 samples themselves. At every block boundary the power is exact. In
+// between, the part of the oldest block that has already left the window is
+// estimated as a matching fraction of that block's sum, so the error is never
+// more than the oldest block's energy (see blockEnergy_getErrorBound).
+
+#define BLOCK_ENERGY_BLOCK_COUNT 20
+#define BLOCK_ENERGY_BLOCK_LENGTH 100
+
+typedef struct {
+  // sums of the squares of the last 20 whole blocks, the oldest at oldestBlock
+  double blockSums[BLOCK_ENERGY_BLOCK_COUNT];
+  uint16_t oldestBlock;
+  // blockSums added up, taken from scratch every time a block finishes
+  double completedSum;
+  // sum of the squares of the block being filled and how many it holds
+  double currentSum;
+  uint16_t currentCount;
+} blockEnergy_t;
+
+// Clears the energy.
+void blockEnergy_init(blockEnergy_t *energy);
+
+// Adds the square of the newest sample.
+void blockEnergy_addSquare(blockEnergy_t *energy, double square);
+
+// Returns the estimated energy of the last 2000 samples.
+double blockEnergy_getPower(const blockEnergy_t *energy);
+
+// Returns the largest amount blockEnergy_getPower can be off by right now.
+double blockEnergy_getErrorBound(const blockEnergy_t *energy);
+
+#endif /* BLOCKENERGY_H_ */
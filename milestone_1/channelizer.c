@@ -0,0 +1,293 @@
+#include "channelizer.h"
+#include "filter.h"
+#include "filterModes.h"
+#include "intervalTimer.h"
+#include "simdKernels.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+#define INDEX_OFFSET 1
+
+// the prototype filter spans 8 samples per channel, and a block is taken
+// every 50 samples so that 40 blocks cover the 2000-sample power window
+#define TAPS_PER_BRANCH 8
+#define MAX_PROTOTYPE_LENGTH (CHANNELIZER_MAX_CHANNEL_COUNT * TAPS_PER_BRANCH)
+#define BLOCK_HOP 50
+#define BLOCKS_PER_WINDOW (FILTER_INPUT_PULSE_WIDTH / BLOCK_HOP)
+
+// the prototype is a Blackman windowed sinc whose cutoff is 0.75 of the
+// channel spacing, normalized to unit gain at DC
+#define PROTOTYPE_CUTOFF_IN_CHANNELS 0.75
+#define BLACKMAN_A0 0.42
+#define BLACKMAN_A1 0.5
+#define BLACKMAN_A2 0.08
+
+// a tone of amplitude A at a channel center comes out with magnitude A / 2,
+// so 40 blocks add up to 10 A^2 where the 2000-sample power is 1000 A^2
+#define POWER_SCALE (2.0 * BLOCK_HOP)
+
+// benchmark settings
+#define BENCHMARK_SAMPLE_COUNT 20000
+#define BENCHMARK_INPUT_STEP 0.3
+#define BENCHMARK_SMALLEST_CHANNEL_COUNT 16
+#define BENCHMARK_TIMER INTERVAL_TIMER_TIMER_0
+
+static uint16_t channelCount;
+static uint16_t prototypeLength;
+static double prototype[MAX_PROTOTYPE_LENGTH];
+
+// the newest prototypeLength samples are always contiguous, oldest first,
+// starting at historyIndex, because every sample is written twice (the same
+// mirrored layout as the FIR history in filter.c)
+static double history[2 * MAX_PROTOTYPE_LENGTH];
+static uint16_t historyIndex;
+static uint16_t samplesUntilBlock;
+
+// FFT input and output, twiddle factors and bit-reversed positions
+static double foldedReal[CHANNELIZER_MAX_CHANNEL_COUNT];
+static double foldedImaginary[CHANNELIZER_MAX_CHANNEL_COUNT];
+static double twiddleReal[CHANNELIZER_MAX_CHANNEL_COUNT / 2];
+static double twiddleImaginary[CHANNELIZER_MAX_CHANNEL_COUNT / 2];
+static uint16_t bitReversed[CHANNELIZER_MAX_CHANNEL_COUNT];
+
+// squared output of every channel for the last 40 blocks, the oldest at
+// blockIndex. channelPower is updated by adding the newest and subtracting
+// the oldest, and replaced by windowSum (the same sum taken from scratch)
+// every time blockIndex wraps, so rounding never builds up
+static double blockPowers[BLOCKS_PER_WINDOW][CHANNELIZER_MAX_CHANNEL_COUNT];
+static uint16_t blockIndex;
+static double channelPower[CHANNELIZER_MAX_CHANNEL_COUNT];
+static double windowSum[CHANNELIZER_MAX_CHANNEL_COUNT];
+
+// weights the history by the prototype, folds it and transforms it, then
+// updates the power of every channel
+static void processBlock();
+
+// in-place radix-2 FFT of foldedReal and foldedImaginary
+static void transformFolded();
+
+// Sets up channelCount channels and clears the history and powers.
+void channelizer_init(uint16_t count) {
+  channelCount = count;
+  prototypeLength = channelCount * TAPS_PER_BRANCH;
+
+  // windowed sinc centered on the middle of the prototype
+  double cutoff = PROTOTYPE_CUTOFF_IN_CHANNELS / channelCount;
+  double center = (prototypeLength - INDEX_OFFSET) / 2.0;
+  double gain = INITIAL_VALUE;
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < prototypeLength; i++) {
+    double t = i - center;
+    double sinc = 2.0 * cutoff;
+    // case this is not the exact middle, where sin(x)/x is 1
+    if (t != INITIAL_VALUE) {
+      sinc = sin(TEST_SIGNAL_TWO_PI * cutoff * t) /
+             (TEST_SIGNAL_TWO_PI / 2.0 * t);
+    }
+    double phase = TEST_SIGNAL_TWO_PI * i / (prototypeLength - INDEX_OFFSET);
+    double window = BLACKMAN_A0 - BLACKMAN_A1 * cos(phase) +
+                    BLACKMAN_A2 * cos(2.0 * phase);
+    prototype[i] = sinc * window;
+    gain += prototype[i];
+  }
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < prototypeLength; i++) {
+    prototype[i] = prototype[i] / gain;
+  }
+
+  // twiddles e^(-j 2 pi k / channelCount) and the bit-reversed order
+  uint16_t bits = FOR_LOOP_START_VALUE;
+  while ((INDEX_OFFSET << bits) < channelCount) {
+    bits++;
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount / 2; k++) {
+    twiddleReal[k] = cos(TEST_SIGNAL_TWO_PI * k / channelCount);
+    twiddleImaginary[k] = -sin(TEST_SIGNAL_TWO_PI * k / channelCount);
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount; k++) {
+    uint16_t reversed = FOR_LOOP_START_VALUE;
+    for (uint16_t b = FOR_LOOP_START_VALUE; b < bits; b++) {
+      reversed = (reversed << INDEX_OFFSET) | ((k >> b) & INDEX_OFFSET);
+    }
+    bitReversed[k] = reversed;
+  }
+
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < 2 * prototypeLength; i++) {
+    history[i] = INITIAL_VALUE;
+  }
+  historyIndex = FOR_LOOP_START_VALUE;
+  samplesUntilBlock = BLOCK_HOP;
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount; k++) {
+    for (uint16_t b = FOR_LOOP_START_VALUE; b < BLOCKS_PER_WINDOW; b++) {
+      blockPowers[b][k] = INITIAL_VALUE;
+    }
+    channelPower[k] = INITIAL_VALUE;
+    windowSum[k] = INITIAL_VALUE;
+  }
+  blockIndex = FOR_LOOP_START_VALUE;
+}
+
+// Adds one decimated sample and, every 50 samples, updates the power of
+// every channel.
+void channelizer_addSample(double x) {
+  history[historyIndex] = x;
+  history[historyIndex + prototypeLength] = x;
+  historyIndex++;
+  // case the index reached the mirror, so it wraps back to the start
+  if (historyIndex >= prototypeLength) {
+    historyIndex = FOR_LOOP_START_VALUE;
+  }
+
+  samplesUntilBlock--;
+  // case a block is due
+  if (samplesUntilBlock == FOR_LOOP_START_VALUE) {
+    processBlock();
+    samplesUntilBlock = BLOCK_HOP;
+  }
+}
+
+// Returns the power of the given channel.
+double channelizer_getChannelPower(uint16_t channel) {
+  return channelPower[channel];
+}
+
+// Returns the channel nearest to a transmitter frequency given as a tick
+// count of the 100 kHz transmitter clock.
+uint16_t channelizer_getChannelForTickCount(uint16_t ticks) {
+  double channel =
+      TEST_SIGNAL_CYCLES_PER_SAMPLE_NUMERATOR * channelCount / ticks;
+  return (uint16_t)lround(channel) % channelCount;
+}
+
+// Returns the channel nearest to the given player frequency number.
+uint16_t channelizer_getChannelForFrequencyNumber(uint16_t frequencyNumber) {
+  return channelizer_getChannelForTickCount(
+      filter_frequencyTickTable[frequencyNumber]);
+}
+
+// Times the channelizer and the per-channel IIR filters and prints where
+// they cost the same.
+void channelizer_runCrossoverBenchmark() {
+  filter_powerEngine_t selectedPowerEngine = filter_getPowerEngine();
+
+  // times the IIR filters and power one channel at a time, as the detector
+  // originally ran them
+  filter_setPowerEngine(FILTER_POWER_IIR);
+  filter_reset();
+  intervalTimer_init(BENCHMARK_TIMER);
+  intervalTimer_reset(BENCHMARK_TIMER);
+  intervalTimer_start(BENCHMARK_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < BENCHMARK_SAMPLE_COUNT; n++) {
+    filter_addNewFirOutput(sin(BENCHMARK_INPUT_STEP * n));
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      filter_iirFilter(i);
+      filter_computePower(i, false, false);
+    }
+  }
+  intervalTimer_stop(BENCHMARK_TIMER);
+  double iirChannelSeconds =
+      intervalTimer_getTotalDurationInSeconds(BENCHMARK_TIMER) /
+      BENCHMARK_SAMPLE_COUNT / FILTER_FREQUENCY_COUNT;
+  printf("IIR filter and power: %e seconds (%.0f cycles) per channel per "
+         "decimated sample\n",
+         iirChannelSeconds, iirChannelSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+
+  // the channelizer costs the same for every channel it has, so it beats the
+  // IIR filters once more channels than the break-even count are needed
+  for (uint16_t count = BENCHMARK_SMALLEST_CHANNEL_COUNT;
+       count <= CHANNELIZER_MAX_CHANNEL_COUNT; count = count * 2) {
+    channelizer_init(count);
+    intervalTimer_reset(BENCHMARK_TIMER);
+    intervalTimer_start(BENCHMARK_TIMER);
+    for (uint32_t n = FOR_LOOP_START_VALUE; n < BENCHMARK_SAMPLE_COUNT; n++) {
+      channelizer_addSample(sin(BENCHMARK_INPUT_STEP * n));
+    }
+    intervalTimer_stop(BENCHMARK_TIMER);
+    double seconds = intervalTimer_getTotalDurationInSeconds(BENCHMARK_TIMER) /
+                     BENCHMARK_SAMPLE_COUNT;
+    printf("%3d channels: %e seconds (%.0f cycles) per decimated sample, the "
+           "cost of %.1f IIR channels\n",
+           count, seconds, seconds * FILTER_BENCHMARK_CPU_CLOCK_HZ,
+           seconds / iirChannelSeconds);
+  }
+  channelizer_init(CHANNELIZER_DEFAULT_CHANNEL_COUNT);
+  // puts back the caller's power engine
+  filter_setPowerEngine(selectedPowerEngine);
+  filter_reset();
+}
+
+// weights the history by the prototype, folds it and transforms it, then
+// updates the power of every channel
+static void processBlock() {
+  const double *newest = &history[historyIndex];
+  for (uint16_t m = FOR_LOOP_START_VALUE; m < channelCount; m++) {
+    foldedReal[m] = INITIAL_VALUE;
+    foldedImaginary[m] = INITIAL_VALUE;
+  }
+  // sample m + p * channelCount of the span lands on point m
+  for (uint16_t p = FOR_LOOP_START_VALUE; p < TAPS_PER_BRANCH; p++) {
+    simdKernels_multiplyAccumulate(foldedReal, &prototype[p * channelCount],
+                                   &newest[p * channelCount], channelCount);
+  }
+  transformFolded();
+
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount; k++) {
+    double power = POWER_SCALE * (foldedReal[k] * foldedReal[k] +
+                                  foldedImaginary[k] * foldedImaginary[k]);
+    channelPower[k] = channelPower[k] + power - blockPowers[blockIndex][k];
+    windowSum[k] = windowSum[k] + power;
+    blockPowers[blockIndex][k] = power;
+  }
+
+  blockIndex++;
+  // case every block in the window was replaced, so the sums taken from
+  // scratch replace the running ones
+  if (blockIndex >= BLOCKS_PER_WINDOW) {
+    blockIndex = FOR_LOOP_START_VALUE;
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount; k++) {
+      channelPower[k] = windowSum[k];
+      windowSum[k] = INITIAL_VALUE;
+    }
+  }
+}
+
+// in-place radix-2 FFT of foldedReal and foldedImaginary
+static void transformFolded() {
+  // puts the points in bit-reversed order
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < channelCount; k++) {
+    uint16_t j = bitReversed[k];
+    // case this pair has not been swapped yet
+    if (j > k) {
+      double real = foldedReal[k];
+      double imaginary = foldedImaginary[k];
+      foldedReal[k] = foldedReal[j];
+      foldedImaginary[k] = foldedImaginary[j];
+      foldedReal[j] = real;
+      foldedImaginary[j] = imaginary;
+    }
+  }
+
+  // combines transforms of size half into transforms of size 2 * half
+  for (uint16_t half = INDEX_OFFSET; half < channelCount; half = half * 2) {
+    uint16_t twiddleStep = channelCount / (2 * half);
+    for (uint16_t start = FOR_LOOP_START_VALUE; start < channelCount;
+         start += 2 * half) {
+      for (uint16_t j = FOR_LOOP_START_VALUE; j < half; j++) {
+        double wReal = twiddleReal[j * twiddleStep];
+        double wImaginary = twiddleImaginary[j * twiddleStep];
+        uint16_t top = start + j;
+        uint16_t bottom = top + half;
+        double real =
+            wReal * foldedReal[bottom] - wImaginary * foldedImaginary[bottom];
+        double imaginary =
+            wReal * foldedImaginary[bottom] + wImaginary * foldedReal[bottom];
+        foldedReal[bottom] = foldedReal[top] - real;
+        foldedImaginary[bottom] = foldedImaginary[top] - imaginary;
+        foldedReal[top] = foldedReal[top] + real;
+        foldedImaginary[top] = foldedImaginary[top] + imaginary;
+      }
+    }
+  }
+}
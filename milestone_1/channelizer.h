@@ -0,0 +1,54 @@
+#ifndef CHANNELIZER_H_
+#define CHANNELIZER_H_
+
+#include <stdint.h>
+
+// Splits the decimated FIR output into uniformly spaced channels with a
+// polyphase filter bank and an FFT, in place of the IIR filters and
+// filter_computePower. Channel k is centered on k / channelCount cycles per
+// sample (k * 10 kHz / channelCount). Every 50 samples the newest
+// channelCount * 8 samples are weighted by a lowpass prototype filter,
+// folded to channelCount points and transformed, which costs
+// O(channelCount log channelCount) for all channels at once instead of a
+// 10th order filter per channel.
+//
+// The power of a channel is the sum of its squared outputs over the last 40
+// blocks (2000 samples), scaled so that a tone reads the same as the
+// 2000-sample power of an IIR filter with unit gain at that frequency. The
+// prototype is flat to within 0.1 dB across a channel and 39 dB down one
+// channel away, so each player frequency can be read from its nearest
+// channel.
+
+// Largest channel count channelizer_init accepts.
+#define CHANNELIZER_MAX_CHANNEL_COUNT 256
+
+// Channel count filter_init sets up. 64 channels put every player frequency
+// more than one channel away from its neighbors.
+#define CHANNELIZER_DEFAULT_CHANNEL_COUNT 64
+
+// Sets up channelCount channels, which must be a power of two between 4 and
+// CHANNELIZER_MAX_CHANNEL_COUNT, and clears the history and powers.
+void channelizer_init(uint16_t channelCount);
+
+// Adds one decimated sample and, every 50 samples, updates the power of
+// every channel.
+void channelizer_addSample(double x);
+
+// Returns the power of the given channel.
+double channelizer_getChannelPower(uint16_t channel);
+
+// Returns the channel nearest to a transmitter frequency given as a tick
+// count of the 100 kHz transmitter clock, the same units as
+// filter_frequencyTickTable. Works for tick counts outside that table.
+uint16_t channelizer_getChannelForTickCount(uint16_t ticks);
+
+// Returns the channel nearest to the given player frequency number.
+uint16_t channelizer_getChannelForFrequencyNumber(uint16_t frequencyNumber);
+
+// Times the channelizer at every channel count from 16 to
+// CHANNELIZER_MAX_CHANNEL_COUNT and the per-channel IIR filters with
+// filter_computePower, and prints for each channel count the number of IIR
+// channels that cost as much. Reinitializes the filters and the channelizer.
+void channelizer_runCrossoverBenchmark();
+
+#endif /* CHANNELIZER_H_ */
@@ -0,0 +1,226 @@
+#include "exactEnergy.h"
+#include "filter.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+#define INITIAL_SUM 0
+#define INDEX_OFFSET 1
+#define CLAMPED_COUNT_INCREMENT 1
+
+// squares are kept in units of 2^-51, so a rounded square is off by at most
+// 2^-52 and 2000 squares of up to 2 need 1 + 11 + 51 = 63 bits
+#define SQUARE_SCALE 2251799813685248.0
+#define SQUARE_UNIT (1.0 / SQUARE_SCALE)
+#define ROUNDING_OFFSET 0.5
+
+#define WINDOW_SIZE FILTER_INPUT_PULSE_WIDTH
+
+// drift test settings. The signal is noise whose amplitude switches between
+// loud and quiet bursts, so large squares keep passing through the window and
+// leaving their rounding behind in a running sum in double
+#define TEST_LOUD_AMPLITUDE 1.0
+#define TEST_QUIET_AMPLITUDE 0.001
+#define TEST_BURST_LENGTH 3001
+#define TEST_CHECKPOINT_COUNT 16
+// a value whose square is above EXACT_ENERGY_MAX_SQUARE
+#define TEST_CLAMPED_VALUE 2.0
+
+// the window of the drift test
+static double testWindow[WINDOW_SIZE];
+
+// returns true if the square of value is too large to keep and is clamped
+static bool isSquareClamped(double value) {
+  return value * value > EXACT_ENERGY_MAX_SQUARE;
+}
+
+// returns the sum of the squares of count values with the rounding of every
+// square and every addition carried along, so it is off by about one rounding
+// of the sum
+static double computeAccurateSumOfSquares(const double values[],
+                                          uint32_t count);
+
+// Clears the energy.
+void exactEnergy_init(exactEnergy_t *energy) {
+  energy->sum = INITIAL_SUM;
+  energy->clampedCount = FOR_LOOP_START_VALUE;
+}
+
+// Returns the square of value rounded to a multiple of 2^-51, in units of
+// 2^-51, clamped to EXACT_ENERGY_MAX_SQUARE.
+int64_t exactEnergy_quantizeSquare(double value) {
+  double square = value * value;
+  // case the square is too large to keep, so it is clamped
+  if (isSquareClamped(value)) {
+    square = EXACT_ENERGY_MAX_SQUARE;
+  }
+  return (int64_t)(square * SQUARE_SCALE + ROUNDING_OFFSET);
+}
+
+// Adds the square of the sample entering the window and subtracts the square
+// of the one leaving it.
+void exactEnergy_slide(exactEnergy_t *energy, double entering,
+                       double leaving) {
+  energy->sum = energy->sum + exactEnergy_quantizeSquare(entering) -
+                exactEnergy_quantizeSquare(leaving);
+  // case a clamped square enters the window
+  if (isSquareClamped(entering)) {
+    energy->clampedCount = energy->clampedCount + CLAMPED_COUNT_INCREMENT;
+  }
+  // case a clamped square leaves it
+  if (isSquareClamped(leaving)) {
+    energy->clampedCount = energy->clampedCount - CLAMPED_COUNT_INCREMENT;
+  }
+}
+
+// Sets the energy to the sum of the squares of count values.
+void exactEnergy_computeFromScratch(exactEnergy_t *energy,
+                                    const double values[], uint32_t count) {
+  exactEnergy_init(energy);
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    energy->sum = energy->sum + exactEnergy_quantizeSquare(values[i]);
+    // case this square was clamped
+    if (isSquareClamped(values[i])) {
+      energy->clampedCount = energy->clampedCount + CLAMPED_COUNT_INCREMENT;
+    }
+  }
+}
+
+// Returns the energy of the window.
+double exactEnergy_getPower(const exactEnergy_t *energy) {
+  return energy->sum * SQUARE_UNIT;
+}
+
+// Returns how many squares in the window were clamped to
+// EXACT_ENERGY_MAX_SQUARE.
+uint32_t exactEnergy_getClampedCount(const exactEnergy_t *energy) {
+  return energy->clampedCount;
+}
+
+// Returns the most the energy of count rounded squares can be off by.
+double exactEnergy_getResolution(uint32_t count) {
+  return count * SQUARE_UNIT * ROUNDING_OFFSET;
+}
+
+// returns the sum of the squares of count values with the rounding of every
+// square and every addition carried along
+static double computeAccurateSumOfSquares(const double values[],
+                                          uint32_t count) {
+  double sum = INITIAL_VALUE;
+  double roundingSum = INITIAL_VALUE;
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    double square = values[i] * values[i];
+    double newSum = sum + square;
+    // the part of the square the multiply rounded off
+    double squareRounding = fma(values[i], values[i], -square);
+    // the part of the addition that was rounded off, whichever of the two
+    // terms is larger
+    double addedPart = newSum - sum;
+    double additionRounding =
+        (sum - (newSum - addedPart)) + (square - addedPart);
+    roundingSum = roundingSum + squareRounding + additionRounding;
+    sum = newSum;
+  }
+  return sum + roundingSum;
+}
+
+// Slides a 2000-sample window over sampleCount samples of a test signal that
+// switches between loud and quiet bursts, keeping both an integer sum and a
+// running sum in double, and prints how far each one is from the sum taken
+// from scratch at regular checkpoints. Then checks that clamped squares are
+// counted. Returns whether every check passed.
+bool exactEnergy_runDriftTest(uint64_t sampleCount) {
+  exactEnergy_t energy;
+  double runningSum = INITIAL_VALUE;
+  uint32_t noiseState = TEST_SIGNAL_NOISE_SEED;
+  uint16_t windowIndex = FOR_LOOP_START_VALUE;
+  uint64_t checkpointInterval = sampleCount / TEST_CHECKPOINT_COUNT;
+  int64_t largestIntegerDifference = INITIAL_SUM;
+  double largestPowerDifference = INITIAL_VALUE;
+  double largestDoubleDifference = INITIAL_VALUE;
+  double resolution = exactEnergy_getResolution(WINDOW_SIZE);
+  bool passed = true;
+
+  exactEnergy_init(&energy);
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < WINDOW_SIZE; k++) {
+    testWindow[k] = INITIAL_VALUE;
+  }
+  printf("samples | integer sum off by (units of 2^-51) | power off by | "
+         "double sum off by (absolute, relative)\n");
+
+  for (uint64_t n = FOR_LOOP_START_VALUE; n < sampleCount; n++) {
+    // case this burst is a loud one
+    double amplitude = ((n / TEST_BURST_LENGTH) % 2 == FOR_LOOP_START_VALUE)
+                           ? TEST_LOUD_AMPLITUDE
+                           : TEST_QUIET_AMPLITUDE;
+    double x = amplitude * testSignal_nextNoise(&noiseState);
+    double leaving = testWindow[windowIndex];
+    testWindow[windowIndex] = x;
+    windowIndex++;
+    // case the index reached the end of the window, so it wraps to the start
+    if (windowIndex >= WINDOW_SIZE) {
+      windowIndex = FOR_LOOP_START_VALUE;
+    }
+    exactEnergy_slide(&energy, x, leaving);
+    runningSum = runningSum - leaving * leaving + x * x;
+
+    // case this is a checkpoint, so the sums are compared with the sums taken
+    // from scratch: the integer one with the same rounded squares, and the
+    // power and the double one with the accurate sum of the true squares
+    if ((checkpointInterval > FOR_LOOP_START_VALUE) &&
+        ((n + INDEX_OFFSET) % checkpointInterval == FOR_LOOP_START_VALUE)) {
+      exactEnergy_t scratch;
+      double scratchSum = computeAccurateSumOfSquares(testWindow, WINDOW_SIZE);
+      exactEnergy_computeFromScratch(&scratch, testWindow, WINDOW_SIZE);
+      int64_t integerDifference = energy.sum - scratch.sum;
+      double powerDifference = fabs(exactEnergy_getPower(&energy) - scratchSum);
+      double doubleDifference = fabs(runningSum - scratchSum);
+      printf("%llu | %lld | %e | %e, %e\n",
+             (unsigned long long)(n + INDEX_OFFSET),
+             (long long)integerDifference, powerDifference, doubleDifference,
+             doubleDifference / scratchSum);
+      // case the integer sum drifted or the power is further from the true
+      // energy than its resolution allows
+      if ((integerDifference != INITIAL_SUM) ||
+          (powerDifference > resolution)) {
+        passed = false;
+      }
+      // case this is the largest difference so far
+      if (llabs(integerDifference) > largestIntegerDifference) {
+        largestIntegerDifference = llabs(integerDifference);
+      }
+      largestPowerDifference = fmax(largestPowerDifference, powerDifference);
+      largestDoubleDifference = fmax(largestDoubleDifference, doubleDifference);
+    }
+  }
+  printf("largest integer sum difference: %lld\n",
+         (long long)largestIntegerDifference);
+  printf("largest power difference:       %e (resolution %e)\n",
+         largestPowerDifference, resolution);
+  printf("largest double sum difference:  %e\n", largestDoubleDifference);
+
+  // slides a window full of squares too large to keep in and back out, and
+  // checks that the clamped count follows them
+  exactEnergy_init(&energy);
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < WINDOW_SIZE; k++) {
+    exactEnergy_slide(&energy, TEST_CLAMPED_VALUE, INITIAL_VALUE);
+  }
+  uint32_t clampedCount = exactEnergy_getClampedCount(&energy);
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < WINDOW_SIZE; k++) {
+    exactEnergy_slide(&energy, INITIAL_VALUE, TEST_CLAMPED_VALUE);
+  }
+  printf("clamped squares counted: %u of %u, %u left after they slid out\n",
+         (unsigned)clampedCount, (unsigned)WINDOW_SIZE,
+         (unsigned)exactEnergy_getClampedCount(&energy));
+  // case the clamped squares were not all counted in and out
+  if ((clampedCount != WINDOW_SIZE) ||
+      (exactEnergy_getClampedCount(&energy) != FOR_LOOP_START_VALUE)) {
+    passed = false;
+  }
+  printf("drift test %s\n", passed ? "passed" : "FAILED");
+  return passed;
+}
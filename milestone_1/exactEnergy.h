@@ -0,0 +1,68 @@
+#ifndef EXACTENERGY_H_
+#define EXACTENERGY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sliding energy of a signal kept as a sum of integer squares. Each square is
+// rounded to a multiple of 2^-51 once, and the same rounded value is added
+// when the sample enters the window and subtracted when it leaves, so the sum
+// is always exactly the sum of the rounded squares in the window. Unlike a
+// running sum in double it never drifts, however long it runs, and never has
+// to be computed again from scratch. 64-bit integers are used rather than
+// 128-bit ones so it also builds for the 32-bit board.
+
+// Largest square that is kept as is. Larger squares are clamped so 2000 of
+// them still fit in 63 bits. The IIR outputs stay below 1 except for the
+// fundamental of a full-scale square wave, which reaches 4/pi. The energy
+// counts the clamped squares in its window, so a caller can tell when the
+// power it reads is below the true one (see exactEnergy_getClampedCount).
+#define EXACT_ENERGY_MAX_SQUARE 2.0
+
+typedef struct {
+  // sum of the rounded squares in the window, in units of 2^-51
+  int64_t sum;
+  // number of squares in the window that were clamped
+  uint32_t clampedCount;
+} exactEnergy_t;
+
+// Clears the energy.
+void exactEnergy_init(exactEnergy_t *energy);
+
+// Returns the square of value rounded to a multiple of 2^-51, in units of
+// 2^-51, clamped to EXACT_ENERGY_MAX_SQUARE.
+int64_t exactEnergy_quantizeSquare(double value);
+
+// Adds the square of the sample entering the window and subtracts the square
+// of the one leaving it.
+void exactEnergy_slide(exactEnergy_t *energy, double entering, double leaving);
+
+// Sets the energy to the sum of the squares of count values.
+void exactEnergy_computeFromScratch(exactEnergy_t *energy,
+                                    const double values[], uint32_t count);
+
+// Returns the energy of the window.
+double exactEnergy_getPower(const exactEnergy_t *energy);
+
+// Returns how many squares in the window were clamped to
+// EXACT_ENERGY_MAX_SQUARE. While it is not 0, exactEnergy_getPower is below
+// the true energy of the window.
+uint32_t exactEnergy_getClampedCount(const exactEnergy_t *energy);
+
+// Returns the most the energy of count rounded squares can be off by. Any
+// energy below it may be rounding alone, so it is the smallest energy worth
+// comparing: a quiet window whose squares all rounded to 0 reads as 0.
+double exactEnergy_getResolution(uint32_t count);
+
+// Slides a 2000-sample window over sampleCount samples of a test signal that
+// switches between loud and quiet bursts, keeping both an integer sum and a
+// running sum in double, and prints how far each one is from the sum taken
+// from scratch at regular checkpoints. The scratch sum is taken with the
+// rounding of every square and addition carried along, so it is accurate well
+// below exactEnergy_getResolution, and the power has to be within that
+// resolution of it. Then fills a window with squares above
+// EXACT_ENERGY_MAX_SQUARE and checks that all of them are counted as clamped.
+// Returns whether every check passed.
+bool exactEnergy_runDriftTest(uint64_t sampleCount);
+
+#endif /* EXACTENERGY_H_ */
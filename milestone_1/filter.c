@@ -1,10 +1,36 @@
 #include "filter.h"
+#include "filterModes.h"
 #include "queue.h"
+#include "blockEnergy.h"
+#include "exactEnergy.h"
+#include "channelizer.h"
 #include "coef.h"
+#include "generatedKernels.h"
+#include "goertzel.h"
+#include "iirBank.h"
+#include "iqDetector.h"
+#include "intervalTimer.h"
+#include "multistageDecimator.h"
+#include "parallelIir.h"
+#include "simdKernels.h"
+#include "slidingDft.h"
+#include "sosFilter.h"
+#include "testSignal.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #define NUM_IIR_FILTERS 10
 #define NUM_Z_QUEUES NUM_IIR_FILTERS
 #define NUM_OUTPUT_QUEUES NUM_IIR_FILTERS
+// the power arrays are padded to a whole number of vectors so the bank-wide
+// power update runs without a scalar tail. The padding lanes stay zero
+#define POWER_VECTOR_SIZE SIMD_KERNELS_PADDED_COUNT(NUM_IIR_FILTERS)
 
 
 #define ASCII_OFFSET 48
@@ -19,6 +45,16 @@
 #define Y_QUEUE_SIZE 11
 #define Z_QUEUE_SIZE 10
 #define OUTPUT_QUEUE_SIZE 2000
+// with the block-summed or exponential power window the output queues only
+// keep the newest output, since the power no longer needs the oldest one
+#define COMPACT_WINDOW_OUTPUT_QUEUE_SIZE 1
+#define UNALLOCATED_QUEUE_SIZE 0
+
+// an exponential average with a time constant of a quarter of the
+// rectangular window still sees a shot for about as long after it ends as
+// the window does, so the lockout timer covers it. Longer time constants
+// let a shot be counted again (see filter_runExponentialPowerEvaluation)
+#define DEFAULT_POWER_TIME_CONSTANT (OUTPUT_QUEUE_SIZE / 4.0)
 
 #define FOR_LOOP_START_VALUE 0
 #define INITIAL_QUEUE_VALUE 0
@@ -29,6 +65,113 @@
 
 #define OLDEST_VALUE_INDEX 0
 
+// row of iirBCoefficientConstants used as the shared numerator
+#define SHARED_NUMERATOR_ROW 0
+// largest difference allowed between b coefficients of two rows for them
+// to still count as the same numerator (the rows in coef.h differ by ~1e-21)
+#define SHARED_NUMERATOR_TOLERANCE 1e-18
+
+// number of mirrored tap pairs in the folded FIR, plus the middle tap
+// that has no partner when the tap count is odd
+#define FIR_FOLDED_PAIR_COUNT (FIR_FILTER_TAP_COUNT / 2)
+#define FIR_HAS_MIDDLE_TAP (FIR_FILTER_TAP_COUNT % 2)
+
+// number of FIR evaluations timed by filter_runFirBenchmark
+#define FIR_BENCHMARK_ITERATIONS 100000
+#define FIR_BENCHMARK_TIMER INTERVAL_TIMER_TIMER_0
+#define FIR_BENCHMARK_INPUT_STEP 0.001
+
+// number of decimated samples timed by filter_runIirBenchmark
+#define IIR_BENCHMARK_ITERATIONS 20000
+#define IIR_BENCHMARK_TIMER INTERVAL_TIMER_TIMER_0
+#define IIR_BENCHMARK_INPUT_STEP 0.3
+
+// settings of filter_runPowerWindowComparison. The input is a tone at one
+// player frequency after another, switched on and off every segment, so the
+// energy in the window keeps rising and falling
+#define WINDOW_COMPARISON_SAMPLE_COUNT 60000
+#define WINDOW_COMPARISON_SEGMENT_LENGTH 1500
+#define WINDOW_COMPARISON_PLAYER_SEGMENTS 2
+#define WINDOW_COMPARISON_AMPLITUDE 0.5
+#define WINDOW_COMPARISON_BOUND_SLACK 1e-12
+
+// flush-to-zero and denormals-are-zero bits of the x86 MXCSR register, and
+// the flush-to-zero bit of the ARM FPSCR and AArch64 FPCR registers
+#define MXCSR_FLUSH_BITS 0x8040
+#define ARM_FLUSH_BIT (1u << 24)
+
+// added to every direct form output by FILTER_DENORMAL_GUARD_OFFSET. The
+// feedback turns it into a constant of about the same size in every state
+// value, which keeps the decaying state out of the subnormal range without
+// changing the power by anything that can be measured
+#define DENORMAL_OFFSET 1e-20
+#define NO_DENORMAL_OFFSET 0.0
+
+// settings of filter_runDenormalBenchmark. An impulse is followed by enough
+// silence for the state of the filters to decay into subnormal numbers
+// before the timing starts
+#define DENORMAL_BENCHMARK_IMPULSE 1.0
+#define DENORMAL_BENCHMARK_SILENCE 0.0
+#define DENORMAL_BENCHMARK_WARMUP 160000
+#define DENORMAL_BENCHMARK_ITERATIONS 20000
+#define DENORMAL_BENCHMARK_TIMER INTERVAL_TIMER_TIMER_0
+#define DENORMAL_GUARD_COUNT 3
+
+// number of running power updates and of rescans from scratch timed by
+// filter_runPowerBenchmark
+#define POWER_BENCHMARK_ITERATIONS 20000
+#define POWER_BENCHMARK_RESCAN_ITERATIONS 1000
+#define POWER_BENCHMARK_SCALAR_TIMER INTERVAL_TIMER_TIMER_0
+#define POWER_BENCHMARK_BANK_TIMER INTERVAL_TIMER_TIMER_1
+
+// settings of filter_runExponentialPowerEvaluation. Each synthetic shot is
+// the burst signal of one player with a 200 ms burst, at the 10 kHz
+// decimated rate, and is run past every time constant in the list
+#define EVALUATION_SAMPLE_COUNT 16000
+#define EVALUATION_SHOT_START 4000
+#define EVALUATION_SHOT_END 6000
+#define EVALUATION_TIME_CONSTANT_COUNT 4
+#define EVALUATION_SAMPLES_PER_MILLISECOND 10.0
+#define EVALUATION_NOT_DETECTED -1
+
+// the FIR history is written twice, HISTORY_MIRROR_OFFSET apart, so the
+// newest X_QUEUE_SIZE samples are always one contiguous span. The padded
+// tap count lets the vector kernels run without a scalar tail; the padding
+// taps are zero so whatever they read past the span does not matter
+#define FIR_PADDED_TAP_COUNT SIMD_KERNELS_PADDED_COUNT(FIR_FILTER_TAP_COUNT)
+#define HISTORY_MIRROR_OFFSET X_QUEUE_SIZE
+#define FIR_HISTORY_SIZE (2 * X_QUEUE_SIZE + FIR_PADDED_TAP_COUNT - FIR_FILTER_TAP_COUNT)
+#define FIR_HISTORY_INITIAL_INDEX 0
+
+// the generated IIR kernel reads newest-first histories. Each one is written
+// twice, its size apart, at an index that counts down, so the newest values
+// always start at the index and run contiguously towards older ones
+#define GENERATED_Y_HISTORY_SIZE (2 * Y_QUEUE_SIZE)
+#define GENERATED_Z_HISTORY_SIZE (2 * Z_QUEUE_SIZE)
+#define GENERATED_HISTORY_INITIAL_INDEX 0
+
+// the block decimator splits firCoefficients into DECIMATION_VALUE phases of
+// POLYPHASE_TAPS_PER_PHASE taps. Each input sample is multiplied into the
+// partial sums of every decimated output it contributes to, so no input
+// history is kept at all. The taps past the end of firCoefficients are zero
+#define POLYPHASE_TAPS_PER_PHASE ((FIR_FILTER_TAP_COUNT + DECIMATION_VALUE - 1) / DECIMATION_VALUE)
+#define POLYPHASE_OUTPUT_PHASE 0
+#define POLYPHASE_INITIAL_PHASE (DECIMATION_VALUE - 1)
+#define POLYPHASE_NEXT_OUTPUT_INDEX 0
+
+// maps raw 12 bit ADC codes onto -1 to 1, same as the detector's scaling
+#define RAW_ADC_SCALING_RECIPROCAL (1.0 / 2047.5)
+#define ADC_OFFSET 1.0
+
+// the generated kernels have the table sizes written into them, so they
+// have to be generated again whenever coef.h changes shape
+#if (GENERATED_KERNELS_FIR_TAP_COUNT != FIR_FILTER_TAP_COUNT) ||                \
+    (GENERATED_KERNELS_IIR_CHANNEL_COUNT != NUM_IIR_FILTERS) ||                 \
+    (GENERATED_KERNELS_IIR_B_COEFFICIENT_COUNT != IIR_B_COEFFICIENT_COUNT) ||   \
+    (GENERATED_KERNELS_IIR_A_COEFFICIENT_COUNT != IIR_A_COEFFICIENT_COUNT)
+#error "generatedKernels.c does not match coef.h; run generator/kernelGenerator.c again"
+#endif
+
 
 static queue_t xQueue;
 const static queue_size_t xQueue_size = X_QUEUE_SIZE;
@@ -50,13 +193,97 @@ char zQueueNames[Z_QUEUE_NAME_LENGTH] = "zQueue_";
 const static queue_size_t outputQueue_size = OUTPUT_QUEUE_SIZE;
 static queue_t outputQueues[NUM_OUTPUT_QUEUES];
 
+// size the output queues were allocated with, so a reset only allocates them
+// again when the power window needs a different size
+static queue_size_t outputQueuesSize = UNALLOCATED_QUEUE_SIZE;
+
+// true once filter_reset has allocated the x, y and z queues
+static bool queuesAllocated = false;
+
 char outputQueueNames[OUTPUT_QUEUE_NAME_LENGTH] = "outputQueue_";
 
 
 
-double currentPowerValue[NUM_IIR_FILTERS];
-double previousPowerValue[NUM_IIR_FILTERS];
-double oldestValue[NUM_IIR_FILTERS];
+double currentPowerValue[POWER_VECTOR_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+double previousPowerValue[POWER_VECTOR_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+double oldestValue[POWER_VECTOR_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// the newest output of every IIR filter as one vector, for the bank-wide
+// power update
+static double newestOutputs[POWER_VECTOR_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// one output queue copied out in order, so the rescan from scratch can run
+// the vector sum of squares over it
+static double rescanBuffer[OUTPUT_QUEUE_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// true when every row of iirBCoefficientConstants is the same polynomial, so
+// the b*y sum only has to be computed once per decimated sample
+static bool iirNumeratorShared;
+
+// true when firCoefficients[k] == firCoefficients[FIR_FILTER_TAP_COUNT - 1 - k]
+// for every k, so mirrored samples can be added before multiplying
+static bool firCoefficientsSymmetric;
+
+// mirrored copy of the xQueue contents. firHistoryIndex is the slot the next
+// sample goes into, which is also where the oldest sample of the span starts
+static double firHistory[FIR_HISTORY_SIZE] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static uint16_t firHistoryIndex;
+
+// firCoefficients in oldest-sample-first order, zero padded so the span can
+// be handed straight to the dot product kernel
+static double firCoefficientsReversed[FIR_PADDED_TAP_COUNT] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// newest-first histories of the FIR outputs and of every filter's outputs
+// used by the generated IIR kernel
+static double generatedYHistory[GENERATED_Y_HISTORY_SIZE];
+static uint16_t generatedYHistoryIndex;
+static double generatedZHistories[NUM_IIR_FILTERS][GENERATED_Z_HISTORY_SIZE];
+static uint16_t generatedZHistoryIndex;
+
+// polyphaseCoefficients[p][j] is the tap that multiplies a sample p samples
+// before an output into the output j decimated samples after that one.
+// polyphaseAccumulators[j] holds the partial sum of that output and
+// polyphasePhase is the number of samples left until the next output
+static double polyphaseCoefficients[DECIMATION_VALUE][POLYPHASE_TAPS_PER_PHASE];
+static double polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE];
+static uint16_t polyphasePhase;
+
+// decimator used by filter_decimateAdcBlock
+static filter_frontEnd_t frontEnd;
+
+// implementation of the IIR filters used by filter_iirFilterBank
+static filter_iirEngine_t iirEngine = FILTER_IIR_DIRECT_FORM;
+
+// what filter_iirFilterBank and filter_computePower measure the power with
+static filter_powerEngine_t powerEngine = FILTER_POWER_IIR;
+
+// how filter_computePower keeps the 2000-sample power of the IIR outputs
+static filter_powerWindow_t powerWindow = FILTER_POWER_WINDOW_EXACT;
+
+// energy of every IIR filter's outputs when powerWindow is
+// FILTER_POWER_WINDOW_BLOCKS
+static blockEnergy_t outputEnergies[NUM_IIR_FILTERS];
+
+// integer sum of every IIR filter's squared outputs when powerWindow is
+// FILTER_POWER_WINDOW_EXACT_INTEGER
+static exactEnergy_t exactEnergies[NUM_IIR_FILTERS];
+
+// exponential average of every IIR filter's squared outputs when powerWindow
+// is FILTER_POWER_WINDOW_EXPONENTIAL, its time constant in decimated samples
+// and the weight of each new square
+static double averageSquares[NUM_IIR_FILTERS];
+static double powerTimeConstant = DEFAULT_POWER_TIME_CONSTANT;
+static double averageWeight;
+
+// how filter_iirFilterBank keeps the filter state out of the subnormal range,
+// the offset the direct forms add to every output for it, and how many
+// subnormal outputs each filter has produced
+static filter_denormalGuard_t denormalGuard = FILTER_DENORMAL_GUARD_OFF;
+static double denormalOffset = NO_DENORMAL_OFFSET;
+static uint32_t subnormalCounts[NUM_IIR_FILTERS];
+
+// the time constants filter_runExponentialPowerEvaluation tries
+static const double evaluationTimeConstants[EVALUATION_TIME_CONSTANT_COUNT] = {250.0, 500.0, 1000.0, 2000.0};
 
 
 //function that initializes arrays that store the power values that will 
@@ -67,16 +294,161 @@ void init_xQueue();
 void init_yQueue();
 void init_zQueues();
 void init_outputQueues();
+void init_firHistory();
+void init_generatedHistories();
+void init_polyphaseDecimator();
+
+//fills every slot of an allocated queue with zeros
+static void clearQueue(queue_t* queue);
+
+//starts the multistage decimator, power engine or IIR engine only when it
+//is the one selected
+static void initSelectedEngines();
+
+//checks whether every IIR filter uses the same b coefficients
+static bool checkSharedNumerator();
+
+//computes the b*y half of the IIR filter for the given filter number
+static double computeIirNumeratorSum(uint16_t filterNumber);
+
+//computes the a*z half of the IIR filter, subtracts it from the given
+//numerator sum and pushes the result onto the z and output queues
+static double computeIirFeedback(uint16_t filterNumber, double b_and_y_sum);
+
+//times filter_iirFilterBank with the given engine and returns the seconds
+//per decimated sample
+static double timeIirEngine(filter_iirEngine_t engine);
+
+//runs one decimated sample through the generated IIR kernel, updating its
+//histories, and writes the output of every filter to outputs
+static void runGeneratedIirBank(double x, double outputs[]);
+
+//pushes a new output of one IIR filter onto its output queue and, with the
+//block-summed power window, adds its square to the filter's energy
+static void pushIirOutput(uint16_t filterNumber, double output);
+
+//returns the weight of each new square in an exponential average with the
+//given time constant in decimated samples
+static double getAverageWeight(double timeConstant);
+
+//runs the selected IIR engine or power engine on the newest value in the
+//yQueue, which is all of filter_iirFilterBank apart from the denormal guard
+static void runIirFilterBank();
+
+//returns the floating point control register that holds the flush-to-zero
+//bits, and writes it back
+static uint32_t getFloatingPointControl();
+static void setFloatingPointControl(uint32_t control);
+
+//checks whether the FIR coefficient table is symmetric
+static bool checkFirSymmetry();
+
+//computes the FIR output for the newest values in the xQueue without
+//pushing it onto the yQueue
+static double computeFirSum();
+
+//computes the FIR output by adding mirrored samples of the mirrored history
+//before multiplying. only valid when the coefficients are symmetric
+static double computeFoldedFirSum();
 
 
 //function called at the start that initializes each of queues by calling
 //their own respective initialization functions
 void filter_init()
 {
-  init_yQueue();
-  init_xQueue();
-  init_zQueues();
+  filter_initWithFrontEnd(FILTER_FRONT_END_FIR);
+}
+
+//same as filter_init, but also selects the decimator that
+//filter_decimateAdcBlock uses
+void filter_initWithFrontEnd(filter_frontEnd_t selectedFrontEnd)
+{
+  frontEnd = selectedFrontEnd;
+  filter_reset();
+}
+
+//zeros every queue, history and running power and restarts the selected
+//front end and engines. The queues are only allocated by the first call,
+//and the output queues again when the power window needs a different size
+void filter_reset()
+{
+  //case this is the first call, so the queues are allocated
+  if(!queuesAllocated)
+  {
+    init_yQueue();
+    init_xQueue();
+    init_zQueues();
+    iirNumeratorShared = checkSharedNumerator();
+    firCoefficientsSymmetric = checkFirSymmetry();
+    queuesAllocated = true;
+  }
+  clearQueue(&yQueue);
+  clearQueue(&xQueue);
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_Z_QUEUES; i++)
+  {
+    clearQueue(&(zQueues[i]));
+  }
+  init_firHistory();
+  init_generatedHistories();
+  init_polyphaseDecimator();
   init_outputQueues();
+  init_powerQueues();
+  initSelectedEngines();
+}
+
+//starts the multistage decimator, power engine or IIR engine only when it
+//is the one selected, so the unused ones never build their tables
+static void initSelectedEngines()
+{
+  //case one of the multistage decimators was selected
+  if(frontEnd == FILTER_FRONT_END_CIC)
+  {
+    multistageDecimator_init(MULTISTAGE_DECIMATOR_CIC);
+  }
+  else if(frontEnd == FILTER_FRONT_END_HALF_BAND)
+  {
+    multistageDecimator_init(MULTISTAGE_DECIMATOR_HALF_BAND);
+  }
+
+  //case a power engine replaces the IIR filters, so no IIR engine runs
+  if(powerEngine == FILTER_POWER_GOERTZEL)
+  {
+    goertzel_init();
+  }
+  else if(powerEngine == FILTER_POWER_SLIDING_DFT)
+  {
+    slidingDft_init();
+  }
+  else if(powerEngine == FILTER_POWER_CHANNELIZER)
+  {
+    channelizer_init(CHANNELIZER_DEFAULT_CHANNEL_COUNT);
+  }
+  else if(powerEngine == FILTER_POWER_IQ)
+  {
+    iqDetector_init();
+  }
+  //case the IIR filters run with an engine that keeps its own state
+  else if(iirEngine == FILTER_IIR_SOS_FLOAT)
+  {
+    sosFilter_init();
+  }
+  else if(iirEngine == FILTER_IIR_INTERLEAVED)
+  {
+    iirBank_init();
+  }
+  else if(iirEngine == FILTER_IIR_PARALLEL)
+  {
+    parallelIir_init();
+  }
+}
+
+//fills every slot of an allocated queue with zeros
+static void clearQueue(queue_t* queue)
+{
+  for(queue_size_t i = FOR_LOOP_START_VALUE; i < queue_size(queue); i++)
+  {
+    queue_overwritePush(queue, INITIAL_QUEUE_VALUE);
+  }
 }
 
 //function that initializes the xQueue function by calling the queue_init function
@@ -124,25 +496,172 @@ void init_zQueues()
 
 void init_outputQueues()
 {
+  queue_size_t size = outputQueue_size;
+  //case the block-summed or exponential window keeps the power, so only the
+  //newest output is stored
+  if((powerWindow == FILTER_POWER_WINDOW_BLOCKS) || (powerWindow == FILTER_POWER_WINDOW_EXPONENTIAL))
+  {
+    size = COMPACT_WINDOW_OUTPUT_QUEUE_SIZE;
+  }
+  averageWeight = getAverageWeight(powerTimeConstant);
   //iterates through each of the 10 output queues to initialize them
   for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_OUTPUT_QUEUES; i++)
   {
-    outputQueueNames[OUTPUT_NAME_OFFSET] = i + ASCII_OFFSET;
-    queue_init(&(outputQueues[i]), outputQueue_size, outputQueueNames);
+    //case the queues do not have the size the window needs yet, so any old
+    //storage is freed and the queue allocated again
+    if(outputQueuesSize != size)
+    {
+      if(outputQueuesSize != UNALLOCATED_QUEUE_SIZE)
+      {
+        queue_garbageCollect(&(outputQueues[i]));
+      }
+      outputQueueNames[OUTPUT_NAME_OFFSET] = i + ASCII_OFFSET;
+      queue_init(&(outputQueues[i]), size, outputQueueNames);
+    }
+
+    //fills every spot with zeros
+    clearQueue(&(outputQueues[i]));
+    blockEnergy_init(&outputEnergies[i]);
+    exactEnergy_init(&exactEnergies[i]);
+    averageSquares[i] = INITIAL_POWER_VALUES;
+    newestOutputs[i] = INITIAL_QUEUE_VALUE;
+  }
+  outputQueuesSize = size;
+}
+
+//zeros the newest-first histories of the generated IIR kernel
+void init_generatedHistories()
+{
+  generatedYHistoryIndex = GENERATED_HISTORY_INITIAL_INDEX;
+  generatedZHistoryIndex = GENERATED_HISTORY_INITIAL_INDEX;
+  for(uint16_t k = FOR_LOOP_START_VALUE; k < GENERATED_Y_HISTORY_SIZE; k++)
+  {
+    generatedYHistory[k] = INITIAL_QUEUE_VALUE;
+  }
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    for(uint16_t k = FOR_LOOP_START_VALUE; k < GENERATED_Z_HISTORY_SIZE; k++)
+    {
+      generatedZHistories[i][k] = INITIAL_QUEUE_VALUE;
+    }
+  }
+}
+
+//zeros the mirrored FIR history and builds the reversed coefficient table
+void init_firHistory()
+{
+  firHistoryIndex = FIR_HISTORY_INITIAL_INDEX;
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < FIR_HISTORY_SIZE; i++)
+  {
+    firHistory[i] = INITIAL_QUEUE_VALUE;
+  }
+  //the span is stored oldest first, so the coefficients are stored reversed
+  for(uint16_t k = FOR_LOOP_START_VALUE; k < FIR_PADDED_TAP_COUNT; k++)
+  {
+    if(k < FIR_FILTER_TAP_COUNT)
+    {
+      firCoefficientsReversed[k] = firCoefficients[FIR_FILTER_TAP_COUNT - INDEX_OFFSET - k];
+    }
+    else
+    {
+      firCoefficientsReversed[k] = INITIAL_SUM_VALUE;
+    }
+  }
+}
+
+//splits the FIR coefficients into phases for the block decimator and clears
+//its partial sums
+void init_polyphaseDecimator()
+{
+  polyphasePhase = POLYPHASE_INITIAL_PHASE;
+  for(uint16_t p = FOR_LOOP_START_VALUE; p < DECIMATION_VALUE; p++)
+  {
+    for(uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE; j++)
+    {
+      uint16_t tap = p + j * DECIMATION_VALUE;
+      //case the tap is past the end of the table, so it is zero
+      if(tap < FIR_FILTER_TAP_COUNT)
+      {
+        polyphaseCoefficients[p][j] = firCoefficients[tap];
+      }
+      else
+      {
+        polyphaseCoefficients[p][j] = INITIAL_SUM_VALUE;
+      }
+    }
+  }
+  for(uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE; j++)
+  {
+    polyphaseAccumulators[j] = INITIAL_SUM_VALUE;
+  }
+}
 
-    //iterates through each spot and pushes zero onto the queue
-    for(uint16_t j = FOR_LOOP_START_VALUE; j < outputQueue_size; j++)
+//scales a block of raw ADC values and runs them through the decimating FIR
+//in one pass (or through the multistage decimator picked in
+//filter_initWithFrontEnd). The decimated outputs are written to decimatedOutputs (which
+//must hold FILTER_MAX_DECIMATED_OUTPUTS(count) values) and their number is
+//returned. The outputs are not pushed onto the yQueue; use
+//filter_addNewFirOutput for each one before running the IIR filters.
+//The decimator keeps its own state, so blocks can be any length
+uint32_t filter_decimateAdcBlock(const uint32_t adcValues[], uint32_t count, double decimatedOutputs[])
+{
+  //case a multistage decimator was selected in filter_initWithFrontEnd
+  if(frontEnd != FILTER_FRONT_END_FIR)
+  {
+    return multistageDecimator_decimateAdcBlock(adcValues, count, decimatedOutputs);
+  }
+
+  uint32_t outputCount = FOR_LOOP_START_VALUE;
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < count; i++)
+  {
+    double x = adcValues[i] * RAW_ADC_SCALING_RECIPROCAL - ADC_OFFSET;
+    const double *phaseCoefficients = polyphaseCoefficients[polyphasePhase];
+    //adds this sample into every output it contributes to
+    for(uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE; j++)
     {
-      queue_overwritePush(&(outputQueues[i]), INITIAL_QUEUE_VALUE);
+      polyphaseAccumulators[j] = polyphaseAccumulators[j] + phaseCoefficients[j]*x;
     }
 
+    //case this sample completes an output, so it is emitted and the partial
+    //sums move down by one output
+    if(polyphasePhase == POLYPHASE_OUTPUT_PHASE)
+    {
+      decimatedOutputs[outputCount] = polyphaseAccumulators[POLYPHASE_NEXT_OUTPUT_INDEX];
+      outputCount++;
+      for(uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET; j++)
+      {
+        polyphaseAccumulators[j] = polyphaseAccumulators[j + INDEX_OFFSET];
+      }
+      polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET] = INITIAL_SUM_VALUE;
+      polyphasePhase = POLYPHASE_INITIAL_PHASE;
+    }
+    else
+    {
+      polyphasePhase--;
+    }
   }
+  return outputCount;
+}
+
+//pushes a decimated FIR output onto the yQueue so the IIR filters can use it
+void filter_addNewFirOutput(double y)
+{
+  queue_overwritePush(&yQueue, y);
 }
 
 //Use this to copy an input into the input queue of the FIR-filter (xQueue).
+//The input is also written to both halves of the mirrored FIR history
 void filter_addNewInput(double x) 
 { 
   queue_overwritePush(&xQueue, x);
+  firHistory[firHistoryIndex] = x;
+  firHistory[firHistoryIndex + HISTORY_MIRROR_OFFSET] = x;
+  firHistoryIndex++;
+  //case the index reached the mirror, so it wraps back to the start
+  if(firHistoryIndex >= HISTORY_MIRROR_OFFSET)
+  {
+    firHistoryIndex = FIR_HISTORY_INITIAL_INDEX;
+  }
 }
 
 void filter_fillQueue(queue_t *q, double fillValue)
@@ -155,32 +674,884 @@ void filter_fillQueue(queue_t *q, double fillValue)
 
 
 double filter_firFilter()
+{
+  double y_sum = computeFirSum();
+  queue_overwritePush(&yQueue, y_sum);
+  return y_sum;
+}
+
+//runs the FIR filter using the folded form when the coefficients are
+//symmetric (41 multiplies instead of 81) and the plain form otherwise
+double filter_firFilterFolded()
+{
+  double y_sum;
+  //case the table is symmetric, so mirrored samples share a multiply
+  if(firCoefficientsSymmetric)
+  {
+    y_sum = computeFoldedFirSum();
+  }
+  //otherwise we fall back to the plain form
+  else
+  {
+    y_sum = computeFirSum();
+  }
+  queue_overwritePush(&yQueue, y_sum);
+  return y_sum;
+}
+
+//runs the FIR filter as one vectorized dot product over the contiguous span
+//of the mirrored history. Only sees inputs added with filter_addNewInput
+double filter_firFilterContiguous()
+{
+  double y_sum = simdKernels_dotProduct(&firHistory[firHistoryIndex], firCoefficientsReversed, FIR_PADDED_TAP_COUNT);
+  queue_overwritePush(&yQueue, y_sum);
+  return y_sum;
+}
+
+//runs the FIR filter with the kernel generated from coef.h, on the same
+//contiguous span as filter_firFilterContiguous
+double filter_firFilterGenerated()
+{
+  double y_sum = generatedKernels_fir81Tap(&firHistory[firHistoryIndex]);
+  queue_overwritePush(&yQueue, y_sum);
+  return y_sum;
+}
+
+//returns whether filter_firFilterFolded is using the folded form
+bool filter_firCoefficientsAreSymmetric()
+{
+  return firCoefficientsSymmetric;
+}
+
+//checks whether the FIR coefficient table is symmetric
+static bool checkFirSymmetry()
+{
+  for(uint16_t k = FOR_LOOP_START_VALUE; k < FIR_FOLDED_PAIR_COUNT; k++)
+  {
+    //case a coefficient does not match its mirror, so the table is not symmetric
+    if(firCoefficients[k] != firCoefficients[FIR_FILTER_TAP_COUNT - INDEX_OFFSET - k])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//computes the FIR output for the newest values in the xQueue without
+//pushing it onto the yQueue
+static double computeFirSum()
 {
   double y_sum = INITIAL_SUM_VALUE;
   for(uint16_t k = FOR_LOOP_START_VALUE; k < xQueue_size; k++)
   {
     y_sum = y_sum + firCoefficients[k]*queue_readElementAt(&xQueue, xQueue_size - INDEX_OFFSET - k);
   }
-  queue_overwritePush(&yQueue, y_sum);
   return y_sum;
 }
 
+//computes the FIR output by adding mirrored samples before multiplying.
+//tap k multiplies the sample k places from the newest, and its mirror
+//multiplies the sample k places from the oldest. Both are read from the
+//contiguous span of the mirrored history, so each pair is two plain loads
+//instead of two queue reads with a modulo each
+static double computeFoldedFirSum()
+{
+  //the span starts at the oldest sample and ends at the newest
+  const double *span = &firHistory[firHistoryIndex];
+  double y_sum = INITIAL_SUM_VALUE;
+  for(uint16_t k = FOR_LOOP_START_VALUE; k < FIR_FOLDED_PAIR_COUNT; k++)
+  {
+    double pairSum = span[FIR_FILTER_TAP_COUNT - INDEX_OFFSET - k] + span[k];
+    y_sum = y_sum + firCoefficients[k]*pairSum;
+  }
+  //case the tap count is odd and the middle tap still has to be added
+  if(FIR_HAS_MIDDLE_TAP)
+  {
+    y_sum = y_sum + firCoefficients[FIR_FOLDED_PAIR_COUNT]*span[FIR_FOLDED_PAIR_COUNT];
+  }
+  return y_sum;
+}
+
+//times the plain, folded, contiguous and generated FIR filters on the same input and prints the
+//time per call and the largest difference between their outputs
+void filter_runFirBenchmark()
+{
+  double plainSeconds;
+  double foldedSeconds;
+  double contiguousSeconds;
+  double generatedSeconds;
+  double maxDifference = INITIAL_SUM_VALUE;
+  //every timed result is stored here, so the compiler cannot drop a call
+  //whose inputs do not change between iterations
+  volatile double timedOutput;
+
+  filter_reset();
+  intervalTimer_init(FIR_BENCHMARK_TIMER);
+
+  //times the plain form
+  intervalTimer_start(FIR_BENCHMARK_TIMER);
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < FIR_BENCHMARK_ITERATIONS; i++)
+  {
+    timedOutput = computeFirSum();
+  }
+  intervalTimer_stop(FIR_BENCHMARK_TIMER);
+  plainSeconds = intervalTimer_getTotalDurationInSeconds(FIR_BENCHMARK_TIMER);
+
+  //times the folded form
+  intervalTimer_reset(FIR_BENCHMARK_TIMER);
+  intervalTimer_start(FIR_BENCHMARK_TIMER);
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < FIR_BENCHMARK_ITERATIONS; i++)
+  {
+    timedOutput = computeFoldedFirSum();
+  }
+  intervalTimer_stop(FIR_BENCHMARK_TIMER);
+  foldedSeconds = intervalTimer_getTotalDurationInSeconds(FIR_BENCHMARK_TIMER);
+
+  //times the vectorized form on the mirrored history
+  intervalTimer_reset(FIR_BENCHMARK_TIMER);
+  intervalTimer_start(FIR_BENCHMARK_TIMER);
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < FIR_BENCHMARK_ITERATIONS; i++)
+  {
+    timedOutput = simdKernels_dotProduct(&firHistory[firHistoryIndex], firCoefficientsReversed, FIR_PADDED_TAP_COUNT);
+  }
+  intervalTimer_stop(FIR_BENCHMARK_TIMER);
+  contiguousSeconds = intervalTimer_getTotalDurationInSeconds(FIR_BENCHMARK_TIMER);
+
+  //times the generated kernel on the mirrored history
+  intervalTimer_reset(FIR_BENCHMARK_TIMER);
+  intervalTimer_start(FIR_BENCHMARK_TIMER);
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < FIR_BENCHMARK_ITERATIONS; i++)
+  {
+    timedOutput = generatedKernels_fir81Tap(&firHistory[firHistoryIndex]);
+  }
+  intervalTimer_stop(FIR_BENCHMARK_TIMER);
+  generatedSeconds = intervalTimer_getTotalDurationInSeconds(FIR_BENCHMARK_TIMER);
+
+  //feeds a sine wave through the xQueue and compares every form on every sample
+  for(uint32_t i = FOR_LOOP_START_VALUE; i < FIR_BENCHMARK_ITERATIONS; i++)
+  {
+    filter_addNewInput(sin(FIR_BENCHMARK_INPUT_STEP * i));
+    double plainSum = computeFirSum();
+    double contiguousSum = simdKernels_dotProduct(&firHistory[firHistoryIndex], firCoefficientsReversed, FIR_PADDED_TAP_COUNT);
+    double generatedSum = generatedKernels_fir81Tap(&firHistory[firHistoryIndex]);
+    double difference = fmax(fabs(plainSum - computeFoldedFirSum()), fabs(plainSum - contiguousSum));
+    difference = fmax(difference, fabs(plainSum - generatedSum));
+    if(difference > maxDifference)
+    {
+      maxDifference = difference;
+    }
+  }
+
+  printf("FIR coefficients symmetric: %d\n", firCoefficientsSymmetric);
+  printf("plain FIR:  %e seconds per call\n", plainSeconds / FIR_BENCHMARK_ITERATIONS);
+  printf("folded FIR: %e seconds per call\n", foldedSeconds / FIR_BENCHMARK_ITERATIONS);
+  printf("contiguous %s FIR: %e seconds per call\n", simdKernels_getInstructionSetName(), contiguousSeconds / FIR_BENCHMARK_ITERATIONS);
+  printf("generated FIR: %e seconds per call\n", generatedSeconds / FIR_BENCHMARK_ITERATIONS);
+  printf("largest output difference: %e\n", maxDifference);
+}
+
 double filter_iirFilter(uint16_t filterNumber)
+{
+  return computeIirFeedback(filterNumber, computeIirNumeratorSum(filterNumber));
+}
+
+//runs all of the IIR filters for the newest value in the yQueue, with
+//subnormal numbers flushed to zero while they run when that guard is
+//selected
+void filter_iirFilterBank()
+{
+  //case the flush-to-zero guard is selected and the CPU has one, so it is
+  //turned on around the filters and the caller's setting put back after
+  if((denormalGuard == FILTER_DENORMAL_GUARD_FLUSH) && filter_canFlushDenormals())
+  {
+    uint32_t control = getFloatingPointControl();
+#if defined(__SSE2__)
+    setFloatingPointControl(control | MXCSR_FLUSH_BITS);
+#else
+    setFloatingPointControl(control | ARM_FLUSH_BIT);
+#endif
+    runIirFilterBank();
+    setFloatingPointControl(control);
+    return;
+  }
+  runIirFilterBank();
+}
+
+//runs the selected IIR engine or power engine on the newest value in the
+//yQueue. When the b coefficients are shared, the b*y sum is computed once
+//and only the channel specific a*z half is computed for each filter. With
+//the SOS engine the filters run as float biquads instead
+static void runIirFilterBank()
+{
+  double newestInput = queue_readElementAt(&yQueue, yQueue_size - INDEX_OFFSET);
+
+  //case Goertzel replaces the IIR filters, so the newest FIR output only
+  //goes to it
+  if(powerEngine == FILTER_POWER_GOERTZEL)
+  {
+    goertzel_addSample(newestInput);
+    return;
+  }
+  //case the sliding DFT replaces the IIR filters
+  if(powerEngine == FILTER_POWER_SLIDING_DFT)
+  {
+    slidingDft_addSample(newestInput);
+    return;
+  }
+  //case the channelizer replaces the IIR filters
+  if(powerEngine == FILTER_POWER_CHANNELIZER)
+  {
+    channelizer_addSample(newestInput);
+    return;
+  }
+  //case the I/Q mixers replace the IIR filters
+  if(powerEngine == FILTER_POWER_IQ)
+  {
+    iqDetector_addSample(newestInput);
+    return;
+  }
+
+  //case the float biquads were selected, so the newest FIR output goes
+  //through them and only the output queues are updated
+  if(iirEngine == FILTER_IIR_SOS_FLOAT)
+  {
+    float outputs[NUM_IIR_FILTERS];
+    sosFilter_filterBank(newestInput, outputs);
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      pushIirOutput(i, outputs[i]);
+    }
+    return;
+  }
+
+  //case the channel-interleaved bank or the parallel form was selected,
+  //which also only update the output queues
+  if((iirEngine == FILTER_IIR_INTERLEAVED) || (iirEngine == FILTER_IIR_PARALLEL))
+  {
+    double outputs[NUM_IIR_FILTERS];
+    if(iirEngine == FILTER_IIR_INTERLEAVED)
+    {
+      iirBank_filter(newestInput, outputs);
+    }
+    else
+    {
+      parallelIir_filterBank(newestInput, outputs);
+    }
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      pushIirOutput(i, outputs[i]);
+    }
+    return;
+  }
+
+  //case the generated kernel was selected, which also only updates the
+  //output queues
+  if(iirEngine == FILTER_IIR_GENERATED)
+  {
+    double outputs[NUM_IIR_FILTERS];
+    runGeneratedIirBank(newestInput, outputs);
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      pushIirOutput(i, outputs[i]);
+    }
+    return;
+  }
+
+  //case the numerator is not shared, so each filter is run on its own
+  if(!iirNumeratorShared)
+  {
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      filter_iirFilter(i);
+    }
+    return;
+  }
+
+  double b_and_y_sum = computeIirNumeratorSum(SHARED_NUMERATOR_ROW);
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    computeIirFeedback(i, b_and_y_sum);
+  }
+}
+
+//times every IIR engine and filter_iirFilter on its own, and prints the
+//time and cycles per decimated sample along with the largest difference
+//between the interleaved bank, the parallel form, the generated kernel and
+//filter_iirFilter
+void filter_runIirBenchmark()
+{
+  filter_iirEngine_t selectedEngine = iirEngine;
+  filter_powerEngine_t selectedPowerEngine = powerEngine;
+  double referenceSeconds;
+  double maxInterleavedDifference = INITIAL_SUM_VALUE;
+  double maxParallelDifference = INITIAL_SUM_VALUE;
+  double maxGeneratedDifference = INITIAL_SUM_VALUE;
+  double maxOutput = INITIAL_SUM_VALUE;
+
+  //times filter_iirFilter called once per channel, as the detector used to
+  powerEngine = FILTER_POWER_IIR;
+  filter_reset();
+  intervalTimer_init(IIR_BENCHMARK_TIMER);
+  for(uint32_t n = FOR_LOOP_START_VALUE; n < IIR_BENCHMARK_ITERATIONS; n++)
+  {
+    filter_addNewFirOutput(sin(IIR_BENCHMARK_INPUT_STEP * n));
+    intervalTimer_start(IIR_BENCHMARK_TIMER);
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      filter_iirFilter(i);
+    }
+    intervalTimer_stop(IIR_BENCHMARK_TIMER);
+  }
+  referenceSeconds = intervalTimer_getTotalDurationInSeconds(IIR_BENCHMARK_TIMER) / IIR_BENCHMARK_ITERATIONS;
+
+  printf("filter_iirFilter per channel: %e seconds (%.0f cycles) per decimated sample\n", referenceSeconds, referenceSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  double directSeconds = timeIirEngine(FILTER_IIR_DIRECT_FORM);
+  printf("shared numerator bank:        %e seconds (%.0f cycles) per decimated sample\n", directSeconds, directSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  double sosSeconds = timeIirEngine(FILTER_IIR_SOS_FLOAT);
+  printf("float biquads:                %e seconds (%.0f cycles) per decimated sample\n", sosSeconds, sosSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  double interleavedSeconds = timeIirEngine(FILTER_IIR_INTERLEAVED);
+  printf("interleaved %s bank:         %e seconds (%.0f cycles) per decimated sample\n", simdKernels_getInstructionSetName(), interleavedSeconds, interleavedSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  double parallelSeconds = timeIirEngine(FILTER_IIR_PARALLEL);
+  printf("parallel form:                %e seconds (%.0f cycles) per decimated sample\n", parallelSeconds, parallelSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  double generatedSeconds = timeIirEngine(FILTER_IIR_GENERATED);
+  printf("generated kernel:             %e seconds (%.0f cycles) per decimated sample\n", generatedSeconds, generatedSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+
+  //runs the interleaved bank, the parallel form and the generated kernel
+  //next to filter_iirFilter
+  //on the same input
+  filter_reset();
+  iirBank_init();
+  parallelIir_init();
+  for(uint32_t n = FOR_LOOP_START_VALUE; n < IIR_BENCHMARK_ITERATIONS; n++)
+  {
+    double x = sin(IIR_BENCHMARK_INPUT_STEP * n);
+    double interleavedOutputs[NUM_IIR_FILTERS];
+    double parallelOutputs[NUM_IIR_FILTERS];
+    double generatedOutputs[NUM_IIR_FILTERS];
+    filter_addNewFirOutput(x);
+    iirBank_filter(x, interleavedOutputs);
+    parallelIir_filterBank(x, parallelOutputs);
+    runGeneratedIirBank(x, generatedOutputs);
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      double reference = filter_iirFilter(i);
+      maxInterleavedDifference = fmax(maxInterleavedDifference, fabs(reference - interleavedOutputs[i]));
+      maxParallelDifference = fmax(maxParallelDifference, fabs(reference - parallelOutputs[i]));
+      maxGeneratedDifference = fmax(maxGeneratedDifference, fabs(reference - generatedOutputs[i]));
+      maxOutput = fmax(maxOutput, fabs(reference));
+    }
+  }
+  printf("largest output of filter_iirFilter: %e\n", maxOutput);
+  printf("largest interleaved output difference: %e\n", maxInterleavedDifference);
+  printf("largest parallel form output difference: %e\n", maxParallelDifference);
+  printf("largest generated kernel output difference: %e\n", maxGeneratedDifference);
+
+  iirEngine = selectedEngine;
+  powerEngine = selectedPowerEngine;
+  filter_reset();
+}
+
+//times filter_iirFilterBank with the given engine and returns the seconds
+//per decimated sample
+static double timeIirEngine(filter_iirEngine_t engine)
+{
+  iirEngine = engine;
+  filter_reset();
+  intervalTimer_init(IIR_BENCHMARK_TIMER);
+  for(uint32_t n = FOR_LOOP_START_VALUE; n < IIR_BENCHMARK_ITERATIONS; n++)
+  {
+    filter_addNewFirOutput(sin(IIR_BENCHMARK_INPUT_STEP * n));
+    intervalTimer_start(IIR_BENCHMARK_TIMER);
+    filter_iirFilterBank();
+    intervalTimer_stop(IIR_BENCHMARK_TIMER);
+  }
+  return intervalTimer_getTotalDurationInSeconds(IIR_BENCHMARK_TIMER) / IIR_BENCHMARK_ITERATIONS;
+}
+
+//runs one decimated sample through the generated IIR kernel, updating its
+//histories, and writes the output of every filter to outputs
+static void runGeneratedIirBank(double x, double outputs[])
+{
+  const double *zHistories[NUM_IIR_FILTERS];
+  //case the index is at the start, so the newest value goes at the end
+  if(generatedYHistoryIndex == GENERATED_HISTORY_INITIAL_INDEX)
+  {
+    generatedYHistoryIndex = Y_QUEUE_SIZE;
+  }
+  generatedYHistoryIndex--;
+  generatedYHistory[generatedYHistoryIndex] = x;
+  generatedYHistory[generatedYHistoryIndex + Y_QUEUE_SIZE] = x;
+
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    zHistories[i] = &generatedZHistories[i][generatedZHistoryIndex];
+  }
+  generatedKernels_iir10ChannelBank(&generatedYHistory[generatedYHistoryIndex], zHistories, outputs);
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    outputs[i] = outputs[i] + denormalOffset;
+  }
+
+  //the outputs become the newest values of the z histories
+  if(generatedZHistoryIndex == GENERATED_HISTORY_INITIAL_INDEX)
+  {
+    generatedZHistoryIndex = Z_QUEUE_SIZE;
+  }
+  generatedZHistoryIndex--;
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    generatedZHistories[i][generatedZHistoryIndex] = outputs[i];
+    generatedZHistories[i][generatedZHistoryIndex + Z_QUEUE_SIZE] = outputs[i];
+  }
+}
+
+//pushes a new output of one IIR filter onto its output queue and, with the
+//block-summed power window, adds its square to the filter's energy
+static void pushIirOutput(uint16_t filterNumber, double output)
+{
+  //case the integer sum keeps the power, so the output about to be pushed
+  //out of the full queue leaves the sum as the new one enters
+  if(powerWindow == FILTER_POWER_WINDOW_EXACT_INTEGER)
+  {
+    double leaving = queue_readElementAt(&outputQueues[filterNumber], OLDEST_VALUE_INDEX);
+    exactEnergy_slide(&exactEnergies[filterNumber], output, leaving);
+  }
+  queue_overwritePush(&outputQueues[filterNumber], output);
+  newestOutputs[filterNumber] = output;
+  //case the output is subnormal, which the numerical health counters track
+  if((output != INITIAL_SUM_VALUE) && (fabs(output) < DBL_MIN))
+  {
+    subnormalCounts[filterNumber]++;
+  }
+  //case the block-summed window keeps the power
+  if(powerWindow == FILTER_POWER_WINDOW_BLOCKS)
+  {
+    blockEnergy_addSquare(&outputEnergies[filterNumber], output*output);
+  }
+  //case the exponential average keeps the power, which moves the average
+  //towards the new square with one multiply-add
+  else if(powerWindow == FILTER_POWER_WINDOW_EXPONENTIAL)
+  {
+    averageSquares[filterNumber] = averageSquares[filterNumber] + averageWeight*(output*output - averageSquares[filterNumber]);
+  }
+}
+
+//returns the weight of each new square in an exponential average with the
+//given time constant in decimated samples
+static double getAverageWeight(double timeConstant)
+{
+  return 1.0 - exp(-1.0 / timeConstant);
+}
+
+//selects how filter_iirFilterBank keeps the filter state out of the
+//subnormal range. The setting is kept across filter_init calls. When the CPU
+//cannot flush subnormals to zero, FILTER_DENORMAL_GUARD_FLUSH adds the
+//offset instead
+void filter_setDenormalGuard(filter_denormalGuard_t guard)
+{
+  denormalGuard = guard;
+  denormalOffset = NO_DENORMAL_OFFSET;
+  //case the offset is used, either by choice or in place of flush-to-zero
+  if((guard == FILTER_DENORMAL_GUARD_OFFSET) || ((guard == FILTER_DENORMAL_GUARD_FLUSH) && !filter_canFlushDenormals()))
+  {
+    denormalOffset = DENORMAL_OFFSET;
+  }
+}
+
+//returns whether the CPU has a flush-to-zero mode filter_iirFilterBank can
+//turn on
+bool filter_canFlushDenormals()
+{
+#if defined(__SSE2__) || defined(__aarch64__) || (defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__))
+  return true;
+#else
+  return false;
+#endif
+}
+
+//returns the floating point control register that holds the flush-to-zero
+//bits
+static uint32_t getFloatingPointControl()
+{
+#if defined(__SSE2__)
+  return _mm_getcsr();
+#elif defined(__aarch64__)
+  return __builtin_aarch64_get_fpcr();
+#elif defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+  return __builtin_arm_get_fpscr();
+#else
+  return FOR_LOOP_START_VALUE;
+#endif
+}
+
+//writes the floating point control register that holds the flush-to-zero
+//bits
+static void setFloatingPointControl(uint32_t control)
+{
+#if defined(__SSE2__)
+  _mm_setcsr(control);
+#elif defined(__aarch64__)
+  __builtin_aarch64_set_fpcr(control);
+#elif defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+  __builtin_arm_set_fpscr(control);
+#else
+  (void)control;
+#endif
+}
+
+//returns how many subnormal outputs the given filter has produced since the
+//counts were last cleared
+uint32_t filter_getSubnormalCount(uint16_t filterNumber)
+{
+  return subnormalCounts[filterNumber];
+}
+
+//clears the subnormal output counts of every filter
+void filter_clearSubnormalCounts()
+{
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    subnormalCounts[i] = FOR_LOOP_START_VALUE;
+  }
+}
+
+//times filter_iirFilterBank on silence after an impulse with every denormal
+//guard, and prints the time per decimated sample and the subnormal outputs
+//of every filter
+void filter_runDenormalBenchmark()
+{
+  filter_denormalGuard_t selectedGuard = denormalGuard;
+  filter_powerEngine_t selectedPowerEngine = powerEngine;
+  const filter_denormalGuard_t guards[DENORMAL_GUARD_COUNT] = {FILTER_DENORMAL_GUARD_OFF, FILTER_DENORMAL_GUARD_FLUSH, FILTER_DENORMAL_GUARD_OFFSET};
+  const char *guardNames[DENORMAL_GUARD_COUNT] = {"off", "flush to zero", "offset"};
+
+  powerEngine = FILTER_POWER_IIR;
+  printf("flush to zero available: %d\n", filter_canFlushDenormals());
+  for(uint16_t g = FOR_LOOP_START_VALUE; g < DENORMAL_GUARD_COUNT; g++)
+  {
+    filter_setDenormalGuard(guards[g]);
+    filter_reset();
+    filter_clearSubnormalCounts();
+    filter_addNewFirOutput(DENORMAL_BENCHMARK_IMPULSE);
+    filter_iirFilterBank();
+    for(uint32_t n = FOR_LOOP_START_VALUE; n < DENORMAL_BENCHMARK_WARMUP; n++)
+    {
+      filter_addNewFirOutput(DENORMAL_BENCHMARK_SILENCE);
+      filter_iirFilterBank();
+    }
+
+    intervalTimer_init(DENORMAL_BENCHMARK_TIMER);
+    intervalTimer_start(DENORMAL_BENCHMARK_TIMER);
+    for(uint32_t n = FOR_LOOP_START_VALUE; n < DENORMAL_BENCHMARK_ITERATIONS; n++)
+    {
+      filter_addNewFirOutput(DENORMAL_BENCHMARK_SILENCE);
+      filter_iirFilterBank();
+    }
+    intervalTimer_stop(DENORMAL_BENCHMARK_TIMER);
+    double seconds = intervalTimer_getTotalDurationInSeconds(DENORMAL_BENCHMARK_TIMER) / DENORMAL_BENCHMARK_ITERATIONS;
+
+    printf("guard %-13s: %e seconds (%.0f cycles) per silent sample, subnormal outputs per filter:", guardNames[g], seconds, seconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      printf(" %u", (unsigned)subnormalCounts[i]);
+    }
+    printf("\n");
+  }
+
+  filter_setDenormalGuard(selectedGuard);
+  powerEngine = selectedPowerEngine;
+  filter_reset();
+}
+
+//selects how filter_iirFilterBank runs the IIR filters
+void filter_setIirEngine(filter_iirEngine_t engine)
+{
+  iirEngine = engine;
+}
+
+//returns the implementation filter_iirFilterBank uses
+filter_iirEngine_t filter_getIirEngine()
+{
+  return iirEngine;
+}
+
+//selects what filter_iirFilterBank and filter_computePower measure the power
+//with. The setting is kept across filter_init calls
+void filter_setPowerEngine(filter_powerEngine_t engine)
+{
+  powerEngine = engine;
+}
+
+//returns what the power is measured with
+filter_powerEngine_t filter_getPowerEngine()
+{
+  return powerEngine;
+}
+
+//selects how filter_computePower keeps the power of the IIR outputs. The
+//setting is kept across filter_init calls, and has to be made before one
+//since it decides how long the output queues are
+void filter_setPowerWindow(filter_powerWindow_t window)
+{
+  powerWindow = window;
+}
+
+//runs the IIR filters with the exact window next to a block-summed energy of
+//every output, and prints the largest error of the block-summed power along
+//with how close it came to its error bound
+void filter_runPowerWindowComparison()
+{
+  filter_powerWindow_t selectedWindow = powerWindow;
+  filter_powerEngine_t selectedPowerEngine = powerEngine;
+  blockEnergy_t energies[NUM_IIR_FILTERS];
+  double largestError = INITIAL_SUM_VALUE;
+  double largestRelativeError = INITIAL_SUM_VALUE;
+  double largestShareOfBound = INITIAL_SUM_VALUE;
+  double peakPower = INITIAL_SUM_VALUE;
+  uint32_t boundViolations = FOR_LOOP_START_VALUE;
+
+  powerWindow = FILTER_POWER_WINDOW_EXACT;
+  powerEngine = FILTER_POWER_IIR;
+  filter_reset();
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    blockEnergy_init(&energies[i]);
+  }
+
+  for(uint32_t n = FOR_LOOP_START_VALUE; n < WINDOW_COMPARISON_SAMPLE_COUNT; n++)
+  {
+    uint32_t segment = n / WINDOW_COMPARISON_SEGMENT_LENGTH;
+    uint16_t player = (segment / WINDOW_COMPARISON_PLAYER_SEGMENTS) % NUM_IIR_FILTERS;
+    double x = INITIAL_SUM_VALUE;
+    //case this is the first segment of the player, so its tone is on
+    if(segment % WINDOW_COMPARISON_PLAYER_SEGMENTS == FOR_LOOP_START_VALUE)
+    {
+      double cyclesPerSample = testSignal_getCyclesPerSample(player);
+      x = WINDOW_COMPARISON_AMPLITUDE * sin(TEST_SIGNAL_TWO_PI * cyclesPerSample * n);
+    }
+    filter_addNewFirOutput(x);
+    filter_iirFilterBank();
+
+    //compares the two windows of every filter, relative to the strongest
+    //filter since a filter with almost no power has no meaningful relative
+    //error
+    double largestPower = INITIAL_SUM_VALUE;
+    double sampleError = INITIAL_SUM_VALUE;
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+      double exactPower = filter_computePower(i, false, false);
+      double newest = newestOutputs[i];
+      blockEnergy_addSquare(&energies[i], newest*newest);
+      double error = fabs(blockEnergy_getPower(&energies[i]) - exactPower);
+      double bound = blockEnergy_getErrorBound(&energies[i]);
+      //the running sum of the exact window carries rounding from the
+      //largest power it has held, so that is what the slack is taken from
+      peakPower = fmax(peakPower, exactPower);
+      //case the error went past its bound by more than rounding
+      if(error > bound + WINDOW_COMPARISON_BOUND_SLACK*peakPower)
+      {
+        boundViolations++;
+      }
+      //case the bound is not zero, so the share of it that was used counts
+      if(bound > INITIAL_SUM_VALUE)
+      {
+        largestShareOfBound = fmax(largestShareOfBound, error / bound);
+      }
+      largestPower = fmax(largestPower, exactPower);
+      sampleError = fmax(sampleError, error);
+    }
+    largestError = fmax(largestError, sampleError);
+    //case the filters have some power, so the relative error means something
+    if(largestPower > INITIAL_SUM_VALUE)
+    {
+      largestRelativeError = fmax(largestRelativeError, sampleError / largestPower);
+    }
+  }
+
+  printf("block-summed window: %d blocks of %d squares, %u bytes per filter instead of %u\n", BLOCK_ENERGY_BLOCK_COUNT, BLOCK_ENERGY_BLOCK_LENGTH, (unsigned)sizeof(blockEnergy_t), (unsigned)(OUTPUT_QUEUE_SIZE*sizeof(double)));
+  printf("largest power error: %e (%e of the strongest filter's power)\n", largestError, largestRelativeError);
+  printf("largest share of the error bound used: %f\n", largestShareOfBound);
+  printf("times the error went past its bound: %u\n", (unsigned)boundViolations);
+
+  powerWindow = selectedWindow;
+  powerEngine = selectedPowerEngine;
+  filter_reset();
+}
+
+//sets the time constant of the exponential power window in decimated
+//samples. The setting is kept across filter_init calls
+void filter_setPowerTimeConstant(double decimatedSamples)
+{
+  powerTimeConstant = decimatedSamples;
+  averageWeight = getAverageWeight(powerTimeConstant);
+}
+
+//runs synthetic shots at every player frequency through the IIR filters and
+//prints, for a few time constants, how long the exponential window and the
+//rectangular window take to see each shot and how often they agree
+void filter_runExponentialPowerEvaluation(double fudgeFactor)
+{
+  filter_powerWindow_t selectedWindow = powerWindow;
+  filter_powerEngine_t selectedPowerEngine = powerEngine;
+  powerWindow = FILTER_POWER_WINDOW_EXACT;
+  powerEngine = FILTER_POWER_IIR;
+
+  //the hold time is how long after the end of a shot a window still sees
+  //it, at most. A hold longer than the lockout makes the detector count the
+  //same shot again
+  printf("time constant | shots seen (rect, exp) | mean latency ms (rect, exp) | longest hold ms (rect, exp) | wrong hits (rect, exp) | agreement\n");
+  for(uint16_t t = FOR_LOOP_START_VALUE; t < EVALUATION_TIME_CONSTANT_COUNT; t++)
+  {
+    double weight = getAverageWeight(evaluationTimeConstants[t]);
+    uint16_t rectangularSeen = FOR_LOOP_START_VALUE;
+    uint16_t exponentialSeen = FOR_LOOP_START_VALUE;
+    double rectangularLatency = INITIAL_SUM_VALUE;
+    double exponentialLatency = INITIAL_SUM_VALUE;
+    double rectangularHold = INITIAL_SUM_VALUE;
+    double exponentialHold = INITIAL_SUM_VALUE;
+    uint32_t rectangularWrongHits = FOR_LOOP_START_VALUE;
+    uint32_t exponentialWrongHits = FOR_LOOP_START_VALUE;
+    uint32_t agreements = FOR_LOOP_START_VALUE;
+    uint32_t decisionCount = FOR_LOOP_START_VALUE;
+
+    for(uint16_t player = FOR_LOOP_START_VALUE; player < NUM_IIR_FILTERS; player++)
+    {
+      double averages[NUM_IIR_FILTERS];
+      int32_t rectangularFirstHit = EVALUATION_NOT_DETECTED;
+      int32_t exponentialFirstHit = EVALUATION_NOT_DETECTED;
+      int32_t rectangularLastHit = EVALUATION_NOT_DETECTED;
+      int32_t exponentialLastHit = EVALUATION_NOT_DETECTED;
+      testSignal_t signal;
+      testSignal_init(&signal, player, FILTER_FIR_DECIMATION_FACTOR);
+      filter_reset();
+      for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+      {
+        averages[i] = INITIAL_SUM_VALUE;
+      }
+
+      for(uint32_t n = FOR_LOOP_START_VALUE; n < EVALUATION_SAMPLE_COUNT; n++)
+      {
+        double rectangularPowers[NUM_IIR_FILTERS];
+        double exponentialPowers[NUM_IIR_FILTERS];
+        //noise, plus the square wave while the shot is on
+        bool shotOn = (n >= EVALUATION_SHOT_START) && (n < EVALUATION_SHOT_END);
+        double x = testSignal_getSample(&signal, n, shotOn);
+        filter_addNewFirOutput(x);
+        filter_iirFilterBank();
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+          double newest = newestOutputs[i];
+          averages[i] = averages[i] + weight*(newest*newest - averages[i]);
+          rectangularPowers[i] = filter_computePower(i, false, false);
+          exponentialPowers[i] = OUTPUT_QUEUE_SIZE * averages[i];
+        }
+
+        uint16_t rectangularHit = testSignal_findHit(rectangularPowers, fudgeFactor);
+        uint16_t exponentialHit = testSignal_findHit(exponentialPowers, fudgeFactor);
+        //case both made the same decision
+        if(rectangularHit == exponentialHit)
+        {
+          agreements++;
+        }
+        decisionCount++;
+        //case a window saw a player that is not shooting
+        if((rectangularHit != TEST_SIGNAL_NO_HIT) && (rectangularHit != player))
+        {
+          rectangularWrongHits++;
+        }
+        if((exponentialHit != TEST_SIGNAL_NO_HIT) && (exponentialHit != player))
+        {
+          exponentialWrongHits++;
+        }
+        //case this is the first time a window sees the shooting player
+        if((rectangularHit == player) && (rectangularFirstHit == EVALUATION_NOT_DETECTED))
+        {
+          rectangularFirstHit = n;
+        }
+        if((exponentialHit == player) && (exponentialFirstHit == EVALUATION_NOT_DETECTED))
+        {
+          exponentialFirstHit = n;
+        }
+        //keeps track of the last time each window still sees the player
+        if(rectangularHit == player)
+        {
+          rectangularLastHit = n;
+        }
+        if(exponentialHit == player)
+        {
+          exponentialLastHit = n;
+        }
+      }
+      //case the windows saw the shot, so their latencies count
+      if(rectangularFirstHit != EVALUATION_NOT_DETECTED)
+      {
+        rectangularSeen++;
+        rectangularLatency += (rectangularFirstHit - EVALUATION_SHOT_START) / EVALUATION_SAMPLES_PER_MILLISECOND;
+        rectangularHold = fmax(rectangularHold, (rectangularLastHit - EVALUATION_SHOT_END) / EVALUATION_SAMPLES_PER_MILLISECOND);
+      }
+      if(exponentialFirstHit != EVALUATION_NOT_DETECTED)
+      {
+        exponentialSeen++;
+        exponentialLatency += (exponentialFirstHit - EVALUATION_SHOT_START) / EVALUATION_SAMPLES_PER_MILLISECOND;
+        exponentialHold = fmax(exponentialHold, (exponentialLastHit - EVALUATION_SHOT_END) / EVALUATION_SAMPLES_PER_MILLISECOND);
+      }
+    }
+    printf("%13.0f | %18d, %d | %21.1f, %.1f | %21.1f, %.1f | %17u, %u | %f\n", evaluationTimeConstants[t], rectangularSeen, exponentialSeen, rectangularSeen ? rectangularLatency / rectangularSeen : INITIAL_SUM_VALUE, exponentialSeen ? exponentialLatency / exponentialSeen : INITIAL_SUM_VALUE, rectangularHold, exponentialHold, (unsigned)rectangularWrongHits, (unsigned)exponentialWrongHits, (double)agreements / decisionCount);
+  }
+
+  powerWindow = selectedWindow;
+  powerEngine = selectedPowerEngine;
+  filter_reset();
+}
+
+//returns whether filter_iirFilterBank is sharing the b*y sum between filters
+bool filter_iirNumeratorIsShared()
+{
+  return iirNumeratorShared;
+}
+
+//checks whether every IIR filter uses the same b coefficients
+static bool checkSharedNumerator()
+{
+  //compares every row against the shared row one coefficient at a time
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  {
+    for(uint16_t k = FOR_LOOP_START_VALUE; k < IIR_B_COEFFICIENT_COUNT; k++)
+    {
+      double difference = iirBCoefficientConstants[i][k] - iirBCoefficientConstants[SHARED_NUMERATOR_ROW][k];
+      if(fabs(difference) > SHARED_NUMERATOR_TOLERANCE)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//computes the b*y half of the IIR filter for the given filter number
+static double computeIirNumeratorSum(uint16_t filterNumber)
 {
   double b_and_y_sum = INITIAL_SUM_VALUE;
-  double a_and_z_sum = INITIAL_SUM_VALUE;
   for(uint16_t k = FOR_LOOP_START_VALUE; k < yQueue_size; k++)
   {
     b_and_y_sum = b_and_y_sum + (iirBCoefficientConstants[filterNumber][k])*(queue_readElementAt(&yQueue, yQueue_size - INDEX_OFFSET - k));
   }
+  return b_and_y_sum;
+}
+
+//computes the a*z half of the IIR filter, subtracts it from the given
+//numerator sum and pushes the result onto the z and output queues
+static double computeIirFeedback(uint16_t filterNumber, double b_and_y_sum)
+{
+  double a_and_z_sum = INITIAL_SUM_VALUE;
   for(uint16_t k = FOR_LOOP_START_VALUE; k < zQueue_size; k++)
   {
     a_and_z_sum = a_and_z_sum + iirACoefficientConstants[filterNumber][k]*queue_readElementAt(&zQueues[filterNumber], zQueue_size - INDEX_OFFSET - k);
   }
 
-  double filter_sum = b_and_y_sum - a_and_z_sum;
+  double filter_sum = b_and_y_sum - a_and_z_sum + denormalOffset;
   queue_overwritePush(&zQueues[filterNumber], filter_sum);
-  queue_overwritePush(&outputQueues[filterNumber], filter_sum);
+  pushIirOutput(filterNumber, filter_sum);
 
   return filter_sum;
 }
@@ -192,10 +1563,58 @@ double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch,
 {
     double computedPower = 0.0;
 
+    //case Goertzel replaces the IIR filters, so its power is used as is
+    if(powerEngine == FILTER_POWER_GOERTZEL)
+    {
+        currentPowerValue[filterNumber] = goertzel_getPower(filterNumber);
+        return currentPowerValue[filterNumber];
+    }
+    //case the sliding DFT replaces the IIR filters
+    if(powerEngine == FILTER_POWER_SLIDING_DFT)
+    {
+        currentPowerValue[filterNumber] = slidingDft_getPower(filterNumber);
+        return currentPowerValue[filterNumber];
+    }
+    //case the channelizer replaces the IIR filters, so the power of the
+    //channel nearest to the player frequency is used
+    if(powerEngine == FILTER_POWER_CHANNELIZER)
+    {
+        uint16_t channel = channelizer_getChannelForFrequencyNumber(filterNumber);
+        currentPowerValue[filterNumber] = channelizer_getChannelPower(channel);
+        return currentPowerValue[filterNumber];
+    }
+    //case the I/Q mixers replace the IIR filters
+    if(powerEngine == FILTER_POWER_IQ)
+    {
+        currentPowerValue[filterNumber] = iqDetector_getPower(filterNumber);
+        return currentPowerValue[filterNumber];
+    }
+    //case the block-summed window keeps the power, which is up to date
+    //after every output, so there is nothing to compute from scratch
+    if(powerWindow == FILTER_POWER_WINDOW_BLOCKS)
+    {
+        currentPowerValue[filterNumber] = blockEnergy_getPower(&outputEnergies[filterNumber]);
+        return currentPowerValue[filterNumber];
+    }
+    //case the integer sum keeps the power, which is up to date after every
+    //output and never drifts, so a rescan from scratch gives the same sum
+    if(powerWindow == FILTER_POWER_WINDOW_EXACT_INTEGER)
+    {
+        currentPowerValue[filterNumber] = exactEnergy_getPower(&exactEnergies[filterNumber]);
+        return currentPowerValue[filterNumber];
+    }
+    //case the exponential average keeps the power. It is an average square,
+    //so it is scaled to the 2000-sample sum the rectangular window gives
+    if(powerWindow == FILTER_POWER_WINDOW_EXPONENTIAL)
+    {
+        currentPowerValue[filterNumber] = OUTPUT_QUEUE_SIZE*averageSquares[filterNumber];
+        return currentPowerValue[filterNumber];
+    }
+
     if(forceComputeFromScratch)
     {
         double signalValue = 0;
-        for(uint16_t i = FOR_LOOP_START_VALUE; i < outputQueue_size; i++)
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < queue_size(&outputQueues[filterNumber]); i++)
         {
             signalValue = queue_readElementAt(&outputQueues[filterNumber], i);
             computedPower = computedPower + signalValue*signalValue;
@@ -205,7 +1624,7 @@ double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch,
     {
         double previousPower = previousPowerValue[filterNumber];
         double oldest = oldestValue[filterNumber];
-        double newest = queue_readElementAt(&outputQueues[filterNumber], outputQueue_size - INDEX_OFFSET);
+        double newest = newestOutputs[filterNumber];
 
         computedPower = previousPower - (oldest*oldest) + (newest*newest);
     }
@@ -216,11 +1635,174 @@ double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch,
     return computedPower;
 }
 
+//computes the power of every filter at once. The running sums of the exact
+//window are all updated by one vector kernel from the newest outputs and the
+//oldest ones, and a rescan from scratch runs the vector sum of squares over
+//each output queue. Every other power source goes through
+//filter_computePower one filter at a time
+void filter_computePowerBank(bool forceComputeFromScratch)
+{
+    //case the power does not come from the exact window of the IIR outputs
+    if((powerEngine != FILTER_POWER_IIR) || (powerWindow != FILTER_POWER_WINDOW_EXACT))
+    {
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            filter_computePower(i, forceComputeFromScratch, false);
+        }
+        return;
+    }
+
+    if(forceComputeFromScratch)
+    {
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            queue_size_t size = queue_size(&outputQueues[i]);
+            for(uint16_t k = FOR_LOOP_START_VALUE; k < size; k++)
+            {
+                rescanBuffer[k] = queue_readElementAt(&outputQueues[i], k);
+            }
+            previousPowerValue[i] = simdKernels_sumOfSquares(rescanBuffer, size);
+        }
+    }
+    else
+    {
+        simdKernels_slideSumsOfSquares(previousPowerValue, newestOutputs, oldestValue, POWER_VECTOR_SIZE);
+    }
+
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+        currentPowerValue[i] = previousPowerValue[i];
+        oldestValue[i] = queue_readElementAt(&outputQueues[i], OLDEST_VALUE_INDEX);
+    }
+}
+
+//times filter_computePower called for every filter and
+//filter_computePowerBank, both for the running update and for the rescan
+//from scratch, and prints the times and the largest difference between them
+void filter_runPowerBenchmark()
+{
+    filter_powerEngine_t selectedPowerEngine = powerEngine;
+    filter_powerWindow_t selectedWindow = powerWindow;
+    double savedPrevious[POWER_VECTOR_SIZE];
+    double savedOldest[POWER_VECTOR_SIZE];
+    double scalarPowers[NUM_IIR_FILTERS];
+    double scalarSeconds;
+    double bankSeconds;
+    double maxUpdateDifference = INITIAL_SUM_VALUE;
+    double maxRescanDifference = INITIAL_SUM_VALUE;
+
+    powerEngine = FILTER_POWER_IIR;
+    powerWindow = FILTER_POWER_WINDOW_EXACT;
+    filter_reset();
+    filter_computePowerBank(true);
+    intervalTimer_init(POWER_BENCHMARK_SCALAR_TIMER);
+    intervalTimer_init(POWER_BENCHMARK_BANK_TIMER);
+
+    //runs both updates on every sample, putting the running sums back in
+    //between so both start from the same state
+    for(uint32_t n = FOR_LOOP_START_VALUE; n < POWER_BENCHMARK_ITERATIONS; n++)
+    {
+        filter_addNewFirOutput(sin(IIR_BENCHMARK_INPUT_STEP * n));
+        filter_iirFilterBank();
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < POWER_VECTOR_SIZE; i++)
+        {
+            savedPrevious[i] = previousPowerValue[i];
+            savedOldest[i] = oldestValue[i];
+        }
+
+        intervalTimer_start(POWER_BENCHMARK_SCALAR_TIMER);
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            filter_computePower(i, false, false);
+        }
+        intervalTimer_stop(POWER_BENCHMARK_SCALAR_TIMER);
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            scalarPowers[i] = currentPowerValue[i];
+        }
+
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < POWER_VECTOR_SIZE; i++)
+        {
+            previousPowerValue[i] = savedPrevious[i];
+            oldestValue[i] = savedOldest[i];
+        }
+        intervalTimer_start(POWER_BENCHMARK_BANK_TIMER);
+        filter_computePowerBank(false);
+        intervalTimer_stop(POWER_BENCHMARK_BANK_TIMER);
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            maxUpdateDifference = fmax(maxUpdateDifference, fabs(scalarPowers[i] - currentPowerValue[i]));
+        }
+    }
+    scalarSeconds = intervalTimer_getTotalDurationInSeconds(POWER_BENCHMARK_SCALAR_TIMER) / POWER_BENCHMARK_ITERATIONS;
+    bankSeconds = intervalTimer_getTotalDurationInSeconds(POWER_BENCHMARK_BANK_TIMER) / POWER_BENCHMARK_ITERATIONS;
+    printf("running update, filter_computePower per filter: %e seconds (%.0f cycles)\n", scalarSeconds, scalarSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+    printf("running update, %s power bank:                %e seconds (%.0f cycles)\n", simdKernels_getInstructionSetName(), bankSeconds, bankSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+    printf("largest running power difference: %e\n", maxUpdateDifference);
+
+    //times the rescans on the outputs the signal left in the queues
+    intervalTimer_init(POWER_BENCHMARK_SCALAR_TIMER);
+    intervalTimer_start(POWER_BENCHMARK_SCALAR_TIMER);
+    for(uint32_t n = FOR_LOOP_START_VALUE; n < POWER_BENCHMARK_RESCAN_ITERATIONS; n++)
+    {
+        for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+        {
+            scalarPowers[i] = filter_computePower(i, true, false);
+        }
+    }
+    intervalTimer_stop(POWER_BENCHMARK_SCALAR_TIMER);
+    scalarSeconds = intervalTimer_getTotalDurationInSeconds(POWER_BENCHMARK_SCALAR_TIMER) / POWER_BENCHMARK_RESCAN_ITERATIONS;
+    intervalTimer_init(POWER_BENCHMARK_BANK_TIMER);
+    intervalTimer_start(POWER_BENCHMARK_BANK_TIMER);
+    for(uint32_t n = FOR_LOOP_START_VALUE; n < POWER_BENCHMARK_RESCAN_ITERATIONS; n++)
+    {
+        filter_computePowerBank(true);
+    }
+    intervalTimer_stop(POWER_BENCHMARK_BANK_TIMER);
+    bankSeconds = intervalTimer_getTotalDurationInSeconds(POWER_BENCHMARK_BANK_TIMER) / POWER_BENCHMARK_RESCAN_ITERATIONS;
+    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+    {
+        maxRescanDifference = fmax(maxRescanDifference, fabs(scalarPowers[i] - currentPowerValue[i]) / scalarPowers[i]);
+    }
+    printf("rescan, filter_computePower per filter: %e seconds (%.0f cycles)\n", scalarSeconds, scalarSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+    printf("rescan, %s power bank:                %e seconds (%.0f cycles)\n", simdKernels_getInstructionSetName(), bankSeconds, bankSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+    printf("largest relative rescan difference: %e\n", maxRescanDifference);
+
+    powerEngine = selectedPowerEngine;
+    powerWindow = selectedWindow;
+    filter_reset();
+}
+
 double filter_getCurrentPowerValue(uint16_t filterNumber)
 {
     return currentPowerValue[filterNumber];
 }
 
+//returns the smallest power the selected window can tell apart from 0
+double filter_getPowerResolution()
+{
+    //case the integer sum keeps the power, so the squares of quiet outputs
+    //round to 0
+    if(powerWindow == FILTER_POWER_WINDOW_EXACT_INTEGER)
+    {
+        return exactEnergy_getResolution(outputQueue_size);
+    }
+    return INITIAL_SUM_VALUE;
+}
+
+//returns how many of the squares in the window of the given filter were
+//clamped, so a caller can tell its power is below the true one
+uint32_t filter_getClampedSquareCount(uint16_t filterNumber)
+{
+    //case the integer sum keeps the power, which is the only window that
+    //clamps its squares
+    if(powerWindow == FILTER_POWER_WINDOW_EXACT_INTEGER)
+    {
+        return exactEnergy_getClampedCount(&exactEnergies[filterNumber]);
+    }
+    return FOR_LOOP_START_VALUE;
+}
+
 void filter_getCurrentPowerValues(double powerValues[])
 {
     for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
@@ -308,6 +1890,8 @@ queue_t *filter_getZQueue(uint16_t filterNumber)
     return &zQueues[filterNumber];
 }
 
+//the queue is only 2000 outputs long with the exact windows. With the
+//block-summed and exponential windows it holds just the newest output
 queue_t *filter_getIirOutputQueue(uint16_t filterNumber)
 {
     return &outputQueues[filterNumber];
@@ -325,9 +1909,11 @@ queue_t *filter_getIirOutputQueue(uint16_t filterNumber)
 void init_powerQueues()
 {
   //for loop that iterates and corresponds to each output queue for
-  //each IIR Filter
-  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_IIR_FILTERS; i++)
+  //each IIR Filter, padding lanes of the power vectors included
+  for(uint16_t i = FOR_LOOP_START_VALUE; i < POWER_VECTOR_SIZE; i++)
   {
+    currentPowerValue[i] = INITIAL_POWER_VALUES;
     previousPowerValue[i] = INITIAL_POWER_VALUES;
+    oldestValue[i] = INITIAL_POWER_VALUES;
   }
 }
@@ -0,0 +1,245 @@
+#ifndef FILTERMODES_H_
+#define FILTERMODES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Entry points of filter.c that are not part of the provided filter.h.
+// These are the faster alternatives to the per-sample and per-channel
+// functions the detector originally called.
+
+// Decimators that filter_decimateAdcBlock can use. All of them turn the
+// 100 kHz ADC samples into the 10 kHz input of the IIR filters.
+typedef enum {
+  // the 81-tap FIR from coef.h (the default)
+  FILTER_FRONT_END_FIR,
+  // integer CIC decimating by 10 with a 15-tap droop compensator
+  FILTER_FRONT_END_CIC,
+  // 11-tap half-band decimating by 2, then a 31-tap FIR decimating by 5
+  FILTER_FRONT_END_HALF_BAND
+} filter_frontEnd_t;
+
+// Same as filter_init, but also selects the decimator used by
+// filter_decimateAdcBlock. filter_init selects FILTER_FRONT_END_FIR.
+void filter_initWithFrontEnd(filter_frontEnd_t selectedFrontEnd);
+
+// Zeros the queues, the histories and the running powers and restarts the
+// selected front end and engines. Only the first call (usually the one inside
+// filter_init) allocates the queues, so benchmarks and reports call it
+// between runs. The selected front end and engines are kept.
+void filter_reset();
+
+// Implementations filter_iirFilterBank can use for the IIR filters.
+typedef enum {
+  // the 10th order direct form in double, as in filter_iirFilter (default)
+  FILTER_IIR_DIRECT_FORM,
+  // cascades of 5 float biquads (see sosFilter.h). Only the output queues
+  // are updated; the z queues are left alone
+  FILTER_IIR_SOS_FLOAT,
+  // the direct form in double with all channels stepped together in vector
+  // lanes (see iirBank.h). Also leaves the z queues alone
+  FILTER_IIR_INTERLEAVED,
+  // each filter split into a direct term plus 5 independent sections that
+  // are summed (see parallelIir.h). Also leaves the z queues alone
+  FILTER_IIR_PARALLEL,
+  // the direct form unrolled by generator/kernelGenerator.c with the
+  // coefficients written into the code, the zero b taps left out and the
+  // shared numerator folded (see generatedKernels.h). Also leaves the z
+  // queues alone
+  FILTER_IIR_GENERATED
+} filter_iirEngine_t;
+
+// Selects the implementation filter_iirFilterBank uses. The setting is kept
+// across filter_init calls, and only the selected engine is started by them,
+// so call filter_init or filter_reset after changing it.
+void filter_setIirEngine(filter_iirEngine_t engine);
+
+// Returns the implementation filter_iirFilterBank uses, so a report can put
+// it back after running with another one.
+filter_iirEngine_t filter_getIirEngine();
+
+// What filter_iirFilterBank and filter_computePower measure the power at each
+// player frequency with.
+typedef enum {
+  // the IIR filters and the 2000-sample power of their outputs (default)
+  FILTER_POWER_IIR,
+  // Goertzel over 2000-sample blocks in place of the IIR filters (see
+  // goertzel.h). filter_iirFilterBank only feeds it, and filter_computePower
+  // returns its power
+  FILTER_POWER_GOERTZEL,
+  // sliding DFT bins in place of the IIR filters (see slidingDft.h), with the
+  // power of the last 2000 samples after every sample
+  FILTER_POWER_SLIDING_DFT,
+  // polyphase FFT channelizer in place of the IIR filters (see
+  // channelizer.h), read at the channel nearest to each player frequency
+  FILTER_POWER_CHANNELIZER,
+  // I/Q mixing with oscillators built from filter_frequencyTickTable and
+  // 2000-sample sums in place of the IIR filters (see iqDetector.h)
+  FILTER_POWER_IQ
+} filter_powerEngine_t;
+
+// Selects what the power is measured with. The setting is kept across
+// filter_init calls, so it can be set before filter_init. Only the selected
+// engine is started by filter_init and filter_reset.
+void filter_setPowerEngine(filter_powerEngine_t engine);
+
+// Returns what the power is measured with.
+filter_powerEngine_t filter_getPowerEngine();
+
+// How filter_computePower keeps the 2000-sample power of the IIR outputs.
+typedef enum {
+  // the 2000 newest outputs of every filter in its output queue, with the
+  // oldest square subtracted as each new one is added (default)
+  FILTER_POWER_WINDOW_EXACT,
+  // 20 sums of 100 squares per filter (see blockEnergy.h), about 100 times
+  // less memory. Exact at every 100th output and within the oldest block's
+  // energy in between. The output queues only keep the newest output
+  FILTER_POWER_WINDOW_BLOCKS,
+  // an exponential moving average of every filter's squared outputs, scaled
+  // to match the 2000-sample sum. One multiply-add per filter per sample and
+  // no history; the output queues only keep the newest output
+  FILTER_POWER_WINDOW_EXPONENTIAL,
+  // the same window as FILTER_POWER_WINDOW_EXACT with the running sum kept as
+  // integer squares (see exactEnergy.h), so it never drifts and never needs a
+  // rescan from scratch
+  FILTER_POWER_WINDOW_EXACT_INTEGER
+} filter_powerWindow_t;
+
+// Returns the smallest power the selected window can tell apart from 0, or 0
+// when every power it keeps is nonzero as soon as its outputs are. A hit
+// check compares the median power with at least this much, so a median that
+// only rounded to 0 does not make every channel look like a hit.
+double filter_getPowerResolution();
+
+// Returns how many of the squares in the window of the given filter were
+// clamped by FILTER_POWER_WINDOW_EXACT_INTEGER (see EXACT_ENERGY_MAX_SQUARE in
+// exactEnergy.h). While it is not 0 the filter's power is below its true
+// value. Always 0 with the other windows, which keep every square as is.
+uint32_t filter_getClampedSquareCount(uint16_t filterNumber);
+
+// Selects how the power of the IIR outputs is kept. The setting is kept
+// across filter_init calls and has to be made before filter_init, which
+// sizes the output queues for it.
+void filter_setPowerWindow(filter_powerWindow_t window);
+
+// filter_getIirOutputQueue (filter.h) returns a queue of the last 2000
+// outputs with the two exact windows, and a queue of only the newest output
+// with FILTER_POWER_WINDOW_BLOCKS and FILTER_POWER_WINDOW_EXPONENTIAL. Read
+// its length with queue_size rather than assuming 2000.
+
+// Sets the time constant of FILTER_POWER_WINDOW_EXPONENTIAL in decimated
+// samples (500 by default). The setting is kept across filter_init calls.
+void filter_setPowerTimeConstant(double decimatedSamples);
+
+// Runs synthetic shots at every player frequency through the IIR filters and
+// prints, for several time constants, how quickly the exponential and the
+// rectangular window see each shot, their hits on the wrong player and how
+// often their decisions agree.
+void filter_runExponentialPowerEvaluation(double fudgeFactor);
+
+// Runs test signals through the IIR filters and prints the largest error of
+// the block-summed power against the exact window, and how much of its error
+// bound it used.
+void filter_runPowerWindowComparison();
+
+// Computes the power of every filter at once, same as calling
+// filter_computePower for each of them. With the IIR filters and the exact
+// window, the 10 running sums are updated together by one vector kernel from
+// the newest outputs, and a rescan from scratch uses a vector sum of squares.
+void filter_computePowerBank(bool forceComputeFromScratch);
+
+// Times filter_computePower per filter against filter_computePowerBank, for
+// the running update and for the rescan from scratch, and prints the results.
+void filter_runPowerBenchmark();
+
+// How filter_iirFilterBank keeps the state of decaying filters out of the
+// subnormal range, where every operation can be 10 to 100 times slower.
+typedef enum {
+  // no guard (default)
+  FILTER_DENORMAL_GUARD_OFF,
+  // subnormal numbers are flushed to zero while the filters run (FTZ/DAZ on
+  // x86, FZ on ARM), and the caller's setting is put back after. Covers every
+  // engine. Falls back to the offset on CPUs without such a mode
+  FILTER_DENORMAL_GUARD_FLUSH,
+  // a 1e-20 offset is added to every output of the direct form engines
+  // (FILTER_IIR_DIRECT_FORM and FILTER_IIR_GENERATED), which the feedback
+  // keeps the state above
+  FILTER_DENORMAL_GUARD_OFFSET
+} filter_denormalGuard_t;
+
+// Selects the denormal guard. The setting is kept across filter_init calls.
+void filter_setDenormalGuard(filter_denormalGuard_t guard);
+
+// Returns true if the CPU has a flush-to-zero mode for
+// FILTER_DENORMAL_GUARD_FLUSH.
+bool filter_canFlushDenormals();
+
+// Returns how many subnormal outputs the given filter has produced since the
+// counts were last cleared.
+uint32_t filter_getSubnormalCount(uint16_t filterNumber);
+
+// Clears the subnormal output counts of every filter.
+void filter_clearSubnormalCounts();
+
+// Times filter_iirFilterBank on silence with every denormal guard and prints
+// the time per decimated sample and the subnormal outputs of every filter.
+void filter_runDenormalBenchmark();
+
+// Runs all of the IIR filters on the newest value in the yQueue. When every
+// filter has the same b coefficients (checked in filter_init), the b*y sum
+// is computed once and only the a*z half is computed for each filter.
+void filter_iirFilterBank();
+
+// Returns true if filter_iirFilterBank is sharing the b*y sum.
+bool filter_iirNumeratorIsShared();
+
+// Runs the FIR filter in folded form, adding mirrored samples before
+// multiplying (41 multiplies instead of 81). The pairs are read from the
+// mirrored input history, so like filter_firFilterContiguous it only sees
+// inputs added through filter_addNewInput. Falls back to the plain form when
+// the coefficient table is not symmetric.
+double filter_firFilterFolded();
+
+// Returns true if filter_firFilterFolded is using the folded form.
+bool filter_firCoefficientsAreSymmetric();
+
+// Runs the FIR filter as one vectorized dot product over the mirrored input
+// history, which always holds the newest 81 samples contiguously. Only inputs
+// added through filter_addNewInput reach the mirrored history.
+double filter_firFilterContiguous();
+
+// Runs the FIR filter with the fully unrolled kernel generated from coef.h
+// (see generatedKernels.h), on the same mirrored input history as
+// filter_firFilterContiguous.
+double filter_firFilterGenerated();
+
+// the board's CPU clock, which the benchmarks use to turn times into cycles
+#define FILTER_BENCHMARK_CPU_CLOCK_HZ 650000000.0
+
+// Times filter_iirFilter and every IIR engine and prints the time and
+// cycles per decimated sample.
+void filter_runIirBenchmark();
+
+// Largest number of decimated outputs filter_decimateAdcBlock can produce
+// from a block of count samples.
+#define FILTER_MAX_DECIMATED_OUTPUTS(count)                                    \
+  ((count) / FILTER_FIR_DECIMATION_FACTOR + 1)
+
+// Scales a block of raw ADC values and runs them through the decimating FIR
+// in a single pass (or through the front end selected with
+// filter_initWithFrontEnd), using a polyphase layout that keeps partial sums instead
+// of an input history. Writes the decimated outputs to decimatedOutputs and
+// returns how many there were. The decimation phase carries across calls.
+// This path does not update the xQueue, so it should not be mixed with
+// filter_addNewInput.
+uint32_t filter_decimateAdcBlock(const uint32_t adcValues[], uint32_t count,
+                                 double decimatedOutputs[]);
+
+// Pushes a decimated FIR output onto the yQueue, ready for the IIR filters.
+void filter_addNewFirOutput(double y);
+
+// Times the plain, folded, contiguous and generated FIR filters and prints the
+// results.
+void filter_runFirBenchmark();
+
+#endif /* FILTERMODES_H_ */
@@ -0,0 +1,363 @@
+#include "fixedPointFilter.h"
+#include "coef.h"
+#include "filter.h"
+#include "filterModes.h"
+#include "sosFilter.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0
+#define INDEX_OFFSET 1
+
+// The raw code is centered as 2 * code - 4095, which is exact and lies
+// within +/-4095. That is the double chain's (code / 2047.5 - 1) times 4095
+#define ADC_CODE_SCALE 2
+#define ADC_CODE_CENTER 4095
+#define ADC_CODE_FULL_SCALE 4095.0
+
+// FIR taps are Q31. The sum of the tap magnitudes is 0.67, so a FIR
+// accumulator stays below 0.67 * 4095 * 2^31 < 2^42 and the output, shifted
+// down to the 15 fraction bits of a signal, below 2^27
+#define FIR_TAP_FRACTION_BITS 31
+#define SIGNAL_FRACTION_BITS 15
+#define FIR_OUTPUT_SHIFT (FIR_TAP_FRACTION_BITS - SIGNAL_FRACTION_BITS)
+
+// biquad coefficients are Q30 so that a1 (up to 2 in magnitude) fits an
+// int32_t. The impulse response of any partial cascade sums to less than 2.4
+// in magnitude, so no section output exceeds 2.4 * 2^27 < 2^29, and each of
+// the 5 products in a section stays below 2 * 2^30 * 2^29 = 2^60
+#define IIR_COEFFICIENT_FRACTION_BITS 30
+
+// each squared output (30 fraction bits, below 2^56) is shifted down to 25
+// fraction bits before it is added, so 2000 of them stay below 2^62. The
+// shift drops less than one power unit from each square, so a window loses
+// less than POWER_WINDOW_SIZE units
+#define POWER_SHIFT                                                            \
+  (2 * SIGNAL_FRACTION_BITS - FIXED_POINT_FILTER_POWER_FRACTION_BITS)
+#define POWER_WINDOW_SIZE FILTER_INPUT_PULSE_WIDTH
+
+// polyphase layout of the FIR, the same as the block decimator in filter.c
+#define DECIMATION_VALUE FILTER_FIR_DECIMATION_FACTOR
+#define POLYPHASE_TAPS_PER_PHASE                                               \
+  ((FIR_FILTER_TAP_COUNT + DECIMATION_VALUE - INDEX_OFFSET) / DECIMATION_VALUE)
+#define POLYPHASE_OUTPUT_PHASE 0
+#define POLYPHASE_INITIAL_PHASE (DECIMATION_VALUE - INDEX_OFFSET)
+#define POLYPHASE_NEXT_OUTPUT_INDEX 0
+
+// converts a fixed point power back to the scale of filter_computePower
+#define POWER_TO_DOUBLE_SCALE                                                  \
+  (1.0 / (ADC_CODE_FULL_SCALE * ADC_CODE_FULL_SCALE *                          \
+          (double)((int64_t)1 << FIXED_POINT_FILTER_POWER_FRACTION_BITS)))
+
+// report settings. Each test signal is the burst signal of one player with a
+// long and a short burst, at the ADC rate and given as raw ADC codes, the
+// same signals the float chain's report uses
+#define REPORT_SAMPLE_COUNT 200000
+#define REPORT_BLOCK_SIZE 100
+#define REPORT_DECIMATED_BLOCK_SIZE                                            \
+  FILTER_MAX_DECIMATED_OUTPUTS(REPORT_BLOCK_SIZE)
+#define REPORT_LONG_BURST_START 40000
+#define REPORT_LONG_BURST_END 80000
+#define REPORT_SHORT_BURST_START 120000
+#define REPORT_SHORT_BURST_END 140000
+#define REPORT_ADC_CENTER 2048.0
+#define REPORT_ADC_FULL_SCALE 2047.0
+#define REPORT_ADC_RATE_FACTOR 1
+
+// one biquad section in direct form I, which needs no internal headroom
+// beyond that of its output. x1, x2, y1 and y2 are the previous inputs and
+// outputs, newest first
+typedef struct {
+  int32_t b0, b1, b2, a1, a2;
+  int32_t x1, x2, y1, y2;
+} fixedPointSection_t;
+
+static int32_t polyphaseCoefficients[DECIMATION_VALUE]
+                                    [POLYPHASE_TAPS_PER_PHASE];
+static int64_t polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE];
+static uint16_t polyphasePhase;
+
+static fixedPointSection_t sections[FILTER_FREQUENCY_COUNT]
+                                   [SOS_FILTER_SECTION_COUNT];
+
+// the last 2000 outputs of every filter, the oldest at powerWindowIndex, and
+// the running sum of their (shifted) squares. The sum is exact, so adding the
+// newest square and subtracting the oldest never drifts
+static int32_t powerWindow[FILTER_FREQUENCY_COUNT][POWER_WINDOW_SIZE];
+static uint16_t powerWindowIndex;
+static int64_t currentPower[FILTER_FREQUENCY_COUNT];
+
+// totals of the deviation report over all of its test signals
+typedef struct {
+  double largestDeviation[FILTER_FREQUENCY_COUNT];
+  double peakPower[FILTER_FREQUENCY_COUNT];
+  uint32_t decimatedCount;
+  uint32_t maxChannelMismatches;
+  uint32_t hitFlips;
+} fixedPointReport_t;
+
+// runs the test signal for one player through both chains and adds what it
+// saw to the report
+static void compareWithDoubleChain(uint16_t player, double fudgeFactor,
+                                   fixedPointReport_t *report);
+
+// rounds a double to the nearest integer with the given fraction bits
+static int32_t quantize(double value, uint16_t fractionBits) {
+  return (int32_t)lround(ldexp(value, fractionBits));
+}
+
+// shifts a product sum down by the given bits, rounding to nearest. Right
+// shifts of negative values are arithmetic on the compilers we use
+static int32_t roundShift(int64_t value, uint16_t bits) {
+  return (int32_t)((value + ((int64_t)1 << (bits - INDEX_OFFSET))) >> bits);
+}
+
+// squares an output and drops it to the fraction bits of a power
+static int64_t squareForPower(int32_t value) {
+  return ((int64_t)value * value) >> POWER_SHIFT;
+}
+
+// Quantizes the coef.h tables and clears all filter state and powers.
+void fixedPointFilter_init() {
+  polyphasePhase = POLYPHASE_INITIAL_PHASE;
+  for (uint16_t p = FOR_LOOP_START_VALUE; p < DECIMATION_VALUE; p++) {
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE;
+         j++) {
+      uint16_t tap = p + j * DECIMATION_VALUE;
+      // case the tap is past the end of the table, so it is zero
+      if (tap < FIR_FILTER_TAP_COUNT) {
+        polyphaseCoefficients[p][j] =
+            quantize(firCoefficients[tap], FIR_TAP_FRACTION_BITS);
+      } else {
+        polyphaseCoefficients[p][j] = INITIAL_VALUE;
+      }
+    }
+  }
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE; j++) {
+    polyphaseAccumulators[j] = INITIAL_VALUE;
+  }
+
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    // the sections in double, which have more bits than Q30 keeps, so the
+    // quantization below is the only rounding they see
+    double doubleSections[SOS_FILTER_SECTION_COUNT]
+                         [SOS_FILTER_COEFFICIENT_COUNT];
+    sosFilter_computeSections(i, doubleSections);
+    for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+      const double *c = doubleSections[s];
+      fixedPointSection_t *section = &sections[i][s];
+      section->b0 = quantize(c[SOS_FILTER_B0], IIR_COEFFICIENT_FRACTION_BITS);
+      section->b1 = quantize(c[SOS_FILTER_B1], IIR_COEFFICIENT_FRACTION_BITS);
+      section->b2 = quantize(c[SOS_FILTER_B2], IIR_COEFFICIENT_FRACTION_BITS);
+      section->a1 = quantize(c[SOS_FILTER_A1], IIR_COEFFICIENT_FRACTION_BITS);
+      section->a2 = quantize(c[SOS_FILTER_A2], IIR_COEFFICIENT_FRACTION_BITS);
+      section->x1 = INITIAL_VALUE;
+      section->x2 = INITIAL_VALUE;
+      section->y1 = INITIAL_VALUE;
+      section->y2 = INITIAL_VALUE;
+    }
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < POWER_WINDOW_SIZE; k++) {
+      powerWindow[i][k] = INITIAL_VALUE;
+    }
+    currentPower[i] = INITIAL_VALUE;
+  }
+  powerWindowIndex = FOR_LOOP_START_VALUE;
+}
+
+// Decimates a block of raw ADC codes with the FIR filter.
+uint32_t fixedPointFilter_decimateAdcBlock(const uint32_t adcValues[],
+                                           uint32_t count,
+                                           int32_t decimatedOutputs[]) {
+  uint32_t outputCount = FOR_LOOP_START_VALUE;
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    int32_t x = (int32_t)adcValues[i] * ADC_CODE_SCALE - ADC_CODE_CENTER;
+    const int32_t *phaseCoefficients = polyphaseCoefficients[polyphasePhase];
+    // adds this sample into every output it contributes to
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE;
+         j++) {
+      polyphaseAccumulators[j] += (int64_t)phaseCoefficients[j] * x;
+    }
+
+    // case this sample completes an output, so it is emitted and the partial
+    // sums move down by one output
+    if (polyphasePhase == POLYPHASE_OUTPUT_PHASE) {
+      decimatedOutputs[outputCount] = roundShift(
+          polyphaseAccumulators[POLYPHASE_NEXT_OUTPUT_INDEX], FIR_OUTPUT_SHIFT);
+      outputCount++;
+      for (uint16_t j = FOR_LOOP_START_VALUE;
+           j < POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET; j++) {
+        polyphaseAccumulators[j] = polyphaseAccumulators[j + INDEX_OFFSET];
+      }
+      polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET] =
+          INITIAL_VALUE;
+      polyphasePhase = POLYPHASE_INITIAL_PHASE;
+    } else {
+      polyphasePhase--;
+    }
+  }
+  return outputCount;
+}
+
+// Runs one decimated sample through all 10 IIR filters and updates the power
+// of each.
+void fixedPointFilter_filterBank(int32_t x) {
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    int32_t y = x;
+    // the output of each section is the input of the next one
+    for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+      fixedPointSection_t *section = &sections[i][s];
+      int64_t sum = (int64_t)section->b0 * y + (int64_t)section->b1 * section->x1 +
+                    (int64_t)section->b2 * section->x2 -
+                    (int64_t)section->a1 * section->y1 -
+                    (int64_t)section->a2 * section->y2;
+      section->x2 = section->x1;
+      section->x1 = y;
+      y = roundShift(sum, IIR_COEFFICIENT_FRACTION_BITS);
+      section->y2 = section->y1;
+      section->y1 = y;
+    }
+
+    // the newest output replaces the oldest one in the window
+    int32_t oldest = powerWindow[i][powerWindowIndex];
+    powerWindow[i][powerWindowIndex] = y;
+    currentPower[i] += squareForPower(y) - squareForPower(oldest);
+  }
+
+  powerWindowIndex++;
+  // case the index reached the end of the window, so it wraps to the start
+  if (powerWindowIndex >= POWER_WINDOW_SIZE) {
+    powerWindowIndex = FOR_LOOP_START_VALUE;
+  }
+}
+
+// Returns the current power of the given filter.
+int64_t fixedPointFilter_getCurrentPowerValue(uint16_t filterNumber) {
+  return currentPower[filterNumber];
+}
+
+// Returns the most the rounding of the outputs and squares can take off a
+// power.
+int64_t fixedPointFilter_getPowerResolution() { return POWER_WINDOW_SIZE; }
+
+// Runs one test signal per player through this chain and the double chain
+// and prints how far apart their powers are.
+void fixedPointFilter_runDeviationReport(double fudgeFactor) {
+  fixedPointReport_t report;
+  filter_iirEngine_t selectedIirEngine = filter_getIirEngine();
+  filter_powerEngine_t selectedPowerEngine = filter_getPowerEngine();
+
+  filter_setIirEngine(FILTER_IIR_DIRECT_FORM);
+  filter_setPowerEngine(FILTER_POWER_IIR);
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    report.largestDeviation[i] = INITIAL_VALUE;
+    report.peakPower[i] = INITIAL_VALUE;
+  }
+  report.decimatedCount = FOR_LOOP_START_VALUE;
+  report.maxChannelMismatches = FOR_LOOP_START_VALUE;
+  report.hitFlips = FOR_LOOP_START_VALUE;
+  // one test signal per player frequency, so every filter sees its own tone
+  // as well as tones in its stopband
+  for (uint16_t player = FOR_LOOP_START_VALUE; player < FILTER_FREQUENCY_COUNT;
+       player++) {
+    compareWithDoubleChain(player, fudgeFactor, &report);
+  }
+
+  printf("fixed point deviation over %u decimated samples\n",
+         (unsigned)report.decimatedCount);
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    printf("filter %d: peak power %e, largest deviation %e (%e of peak)\n", i,
+           report.peakPower[i], report.largestDeviation[i],
+           report.largestDeviation[i] / report.peakPower[i]);
+  }
+  printf("strongest filter differs on %u samples\n",
+         (unsigned)report.maxChannelMismatches);
+  printf("hit decisions that differ: %u\n", (unsigned)report.hitFlips);
+  // puts back the caller's engines
+  filter_setIirEngine(selectedIirEngine);
+  filter_setPowerEngine(selectedPowerEngine);
+  filter_reset();
+}
+
+// runs the test signal for one player through both chains and adds what it
+// saw to the report
+static void compareWithDoubleChain(uint16_t player, double fudgeFactor,
+                                   fixedPointReport_t *report) {
+  testSignal_t signal;
+  // powers below the resolution may be rounding alone, so the hit decision
+  // takes them as the resolution, as the detector does with its median
+  double powerFloor =
+      fixedPointFilter_getPowerResolution() * POWER_TO_DOUBLE_SCALE;
+  testSignal_init(&signal, player, REPORT_ADC_RATE_FACTOR);
+
+  filter_reset();
+  fixedPointFilter_init();
+
+  // feeds the signal through both chains one block at a time, the same way
+  // the detector does
+  for (uint32_t start = FOR_LOOP_START_VALUE; start < REPORT_SAMPLE_COUNT;
+       start += REPORT_BLOCK_SIZE) {
+    uint32_t adcValues[REPORT_BLOCK_SIZE];
+    double doubleOutputs[REPORT_DECIMATED_BLOCK_SIZE];
+    int32_t fixedOutputs[REPORT_DECIMATED_BLOCK_SIZE];
+
+    for (uint32_t k = FOR_LOOP_START_VALUE; k < REPORT_BLOCK_SIZE; k++) {
+      uint32_t n = start + k;
+      bool burstOn =
+          ((n >= REPORT_LONG_BURST_START) && (n < REPORT_LONG_BURST_END)) ||
+          ((n >= REPORT_SHORT_BURST_START) && (n < REPORT_SHORT_BURST_END));
+      double x = testSignal_getSample(&signal, n, burstOn);
+      adcValues[k] = REPORT_ADC_CENTER + REPORT_ADC_FULL_SCALE * x;
+    }
+
+    uint32_t outputCount =
+        filter_decimateAdcBlock(adcValues, REPORT_BLOCK_SIZE, doubleOutputs);
+    fixedPointFilter_decimateAdcBlock(adcValues, REPORT_BLOCK_SIZE,
+                                      fixedOutputs);
+
+    for (uint32_t n = FOR_LOOP_START_VALUE; n < outputCount; n++) {
+      double doublePowers[FILTER_FREQUENCY_COUNT];
+      double fixedPowers[FILTER_FREQUENCY_COUNT];
+      filter_addNewFirOutput(doubleOutputs[n]);
+      filter_iirFilterBank();
+      fixedPointFilter_filterBank(fixedOutputs[n]);
+
+      uint16_t doubleMaxChannel = FOR_LOOP_START_VALUE;
+      uint16_t fixedMaxChannel = FOR_LOOP_START_VALUE;
+      for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+           i++) {
+        double fixedPower =
+            fixedPointFilter_getCurrentPowerValue(i) * POWER_TO_DOUBLE_SCALE;
+        doublePowers[i] = filter_computePower(i, false, false);
+        fixedPowers[i] = fmax(fixedPower, powerFloor);
+        report->largestDeviation[i] = fmax(report->largestDeviation[i],
+                                           fabs(fixedPower - doublePowers[i]));
+        report->peakPower[i] = fmax(report->peakPower[i], doublePowers[i]);
+        // case this filter has more power than the largest one so far
+        if (doublePowers[i] > doublePowers[doubleMaxChannel]) {
+          doubleMaxChannel = i;
+        }
+        if (fixedPointFilter_getCurrentPowerValue(i) >
+            fixedPointFilter_getCurrentPowerValue(fixedMaxChannel)) {
+          fixedMaxChannel = i;
+        }
+      }
+      // case the chains disagree about the strongest filter while the fixed
+      // point powers are above rounding, so they can tell the filters apart
+      if ((doubleMaxChannel != fixedMaxChannel) &&
+          (fixedPointFilter_getCurrentPowerValue(fixedMaxChannel) >
+           fixedPointFilter_getPowerResolution())) {
+        report->maxChannelMismatches++;
+      }
+      // case the chains would make a different hit decision
+      if (testSignal_findHit(doublePowers, fudgeFactor) !=
+          testSignal_findHit(fixedPowers, fudgeFactor)) {
+        report->hitFlips++;
+      }
+      report->decimatedCount++;
+    }
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef FIXEDPOINTFILTER_H_
+#define FIXEDPOINTFILTER_H_
+
+#include <stdint.h>
+
+// Integer version of the whole filter chain: decimating FIR, the 10 IIR
+// filters and the 2000-sample power. No floating point is used per sample.
+//
+// Signals keep the scale of the centered ADC code (2 * code - 4095, which is
+// the double chain's scaled value times 4095) with 15 fraction bits, so a
+// full scale input is about +/-2^27 and fits an int32_t. Powers are sums of
+// squared outputs with 25 fraction bits in an int64_t (see
+// fixedPointFilter.c for the headroom). Only ratios of powers matter to the
+// detector, so the 4095^2 scale difference from filter_computePower never has
+// to be divided out.
+
+// number of fraction bits of a fixed point power value
+#define FIXED_POINT_FILTER_POWER_FRACTION_BITS 25
+
+// Quantizes the coef.h tables and clears all filter state and powers.
+void fixedPointFilter_init();
+
+// Decimates a block of raw ADC codes with the FIR filter. Writes the
+// decimated outputs to decimatedOutputs (which must hold count / 10 + 1
+// values) and returns how many there were. State carries across calls.
+uint32_t fixedPointFilter_decimateAdcBlock(const uint32_t adcValues[],
+                                           uint32_t count,
+                                           int32_t decimatedOutputs[]);
+
+// Runs one decimated sample through all 10 IIR filters and updates the power
+// of each.
+void fixedPointFilter_filterBank(int32_t x);
+
+// Returns the current power of the given filter.
+int64_t fixedPointFilter_getCurrentPowerValue(uint16_t filterNumber);
+
+// Returns the most the rounding of the outputs and squares can take off a
+// power. Outputs of a few LSBs, as every filter has right after init, give a
+// power of 0, so a hit check takes the median power as at least this.
+int64_t fixedPointFilter_getPowerResolution();
+
+// Runs one test signal per player (see testSignal.h), given as raw ADC
+// codes, through both this chain and the double chain in filter.c. Prints,
+// for each filter, the largest power deviation relative to that filter's peak
+// power, how often the two chains disagree about which filter has the most
+// power once the fixed point powers are above rounding, and how many times
+// the hit decision (which player's power is above fudgeFactor times the
+// median, if any, with the median at least fixedPointFilter_getPowerResolution
+// in the fixed point chain) differs between them. Reinitializes
+// both chains, and resets the double chain with the caller's engines
+// afterwards.
+void fixedPointFilter_runDeviationReport(double fudgeFactor);
+
+#endif /* FIXEDPOINTFILTER_H_ */
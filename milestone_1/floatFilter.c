@@ -0,0 +1,270 @@
+#include "floatFilter.h"
+#include "coef.h"
+#include "filter.h"
+#include "filterModes.h"
+#include "sosFilter.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0f
+#define INITIAL_SUM_VALUE 0.0
+#define INDEX_OFFSET 1
+
+#define RAW_ADC_SCALING_RECIPROCAL (1.0f / 2047.5f)
+#define ADC_OFFSET 1.0f
+
+// polyphase layout of the FIR, the same as the block decimator in filter.c
+#define DECIMATION_VALUE FILTER_FIR_DECIMATION_FACTOR
+#define POLYPHASE_TAPS_PER_PHASE                                               \
+  ((FIR_FILTER_TAP_COUNT + DECIMATION_VALUE - INDEX_OFFSET) / DECIMATION_VALUE)
+#define POLYPHASE_OUTPUT_PHASE 0
+#define POLYPHASE_INITIAL_PHASE (DECIMATION_VALUE - INDEX_OFFSET)
+#define POLYPHASE_NEXT_OUTPUT_INDEX 0
+
+#define POWER_WINDOW_SIZE FILTER_INPUT_PULSE_WIDTH
+
+// report settings. Each test signal is the burst signal of one player with a
+// long and a short burst, at the ADC rate and given as raw ADC codes
+#define REPORT_SAMPLE_COUNT 200000
+#define REPORT_BLOCK_SIZE 100
+#define REPORT_DECIMATED_BLOCK_SIZE                                            \
+  FILTER_MAX_DECIMATED_OUTPUTS(REPORT_BLOCK_SIZE)
+#define REPORT_LONG_BURST_START 40000
+#define REPORT_LONG_BURST_END 80000
+#define REPORT_SHORT_BURST_START 120000
+#define REPORT_SHORT_BURST_END 140000
+#define REPORT_ADC_CENTER 2048.0
+#define REPORT_ADC_FULL_SCALE 2047.0
+#define REPORT_ADC_RATE_FACTOR 1
+
+static float polyphaseCoefficients[DECIMATION_VALUE][POLYPHASE_TAPS_PER_PHASE];
+static float polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE];
+static uint16_t polyphasePhase;
+
+// the last 2000 outputs of every filter, the oldest at powerWindowIndex.
+// currentPower is updated by adding the newest square and subtracting the
+// oldest. windowSum adds up the squares of the current pass over the window
+// from scratch, and replaces currentPower every time the index wraps, so
+// nothing builds up over time. In float, plain rounding of either sum would
+// leave an error the size of a large power in the small power that follows
+// it, so both carry their rounding error in a compensation term (Kahan
+// summation)
+static float powerWindow[FILTER_FREQUENCY_COUNT][POWER_WINDOW_SIZE];
+static uint16_t powerWindowIndex;
+static float currentPower[FILTER_FREQUENCY_COUNT];
+static float powerCompensation[FILTER_FREQUENCY_COUNT];
+static float windowSum[FILTER_FREQUENCY_COUNT];
+static float windowCompensation[FILTER_FREQUENCY_COUNT];
+
+// adds value to sum, carrying the rounding error in compensation
+static void compensatedAdd(float *sum, float *compensation, float value);
+
+// runs the test signal for one player through both chains, updates the worst
+// power errors and returns the number of hit decisions that differ
+static uint32_t compareWithDoubleChain(uint16_t player, double fudgeFactor,
+                                       double worstPowerError[]);
+
+// Clears all filter state and powers.
+void floatFilter_init() {
+  polyphasePhase = POLYPHASE_INITIAL_PHASE;
+  for (uint16_t p = FOR_LOOP_START_VALUE; p < DECIMATION_VALUE; p++) {
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE;
+         j++) {
+      uint16_t tap = p + j * DECIMATION_VALUE;
+      // case the tap is past the end of the table, so it is zero
+      if (tap < FIR_FILTER_TAP_COUNT) {
+        polyphaseCoefficients[p][j] = firCoefficients[tap];
+      } else {
+        polyphaseCoefficients[p][j] = INITIAL_VALUE;
+      }
+    }
+  }
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE; j++) {
+    polyphaseAccumulators[j] = INITIAL_VALUE;
+  }
+
+  sosFilter_init();
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < POWER_WINDOW_SIZE; k++) {
+      powerWindow[i][k] = INITIAL_VALUE;
+    }
+    currentPower[i] = INITIAL_VALUE;
+    powerCompensation[i] = INITIAL_VALUE;
+    windowSum[i] = INITIAL_VALUE;
+    windowCompensation[i] = INITIAL_VALUE;
+  }
+  powerWindowIndex = FOR_LOOP_START_VALUE;
+}
+
+// Scales and decimates a block of raw ADC values with the FIR filter.
+uint32_t floatFilter_decimateAdcBlock(const uint32_t adcValues[],
+                                      uint32_t count,
+                                      float decimatedOutputs[]) {
+  uint32_t outputCount = FOR_LOOP_START_VALUE;
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    float x = adcValues[i] * RAW_ADC_SCALING_RECIPROCAL - ADC_OFFSET;
+    const float *phaseCoefficients = polyphaseCoefficients[polyphasePhase];
+    // adds this sample into every output it contributes to
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < POLYPHASE_TAPS_PER_PHASE;
+         j++) {
+      polyphaseAccumulators[j] += phaseCoefficients[j] * x;
+    }
+
+    // case this sample completes an output, so it is emitted and the partial
+    // sums move down by one output
+    if (polyphasePhase == POLYPHASE_OUTPUT_PHASE) {
+      decimatedOutputs[outputCount] =
+          polyphaseAccumulators[POLYPHASE_NEXT_OUTPUT_INDEX];
+      outputCount++;
+      for (uint16_t j = FOR_LOOP_START_VALUE;
+           j < POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET; j++) {
+        polyphaseAccumulators[j] = polyphaseAccumulators[j + INDEX_OFFSET];
+      }
+      polyphaseAccumulators[POLYPHASE_TAPS_PER_PHASE - INDEX_OFFSET] =
+          INITIAL_VALUE;
+      polyphasePhase = POLYPHASE_INITIAL_PHASE;
+    } else {
+      polyphasePhase--;
+    }
+  }
+  return outputCount;
+}
+
+// Runs one decimated sample through all 10 IIR filters and updates the power
+// of each.
+void floatFilter_filterBank(float x) {
+  float outputs[FILTER_FREQUENCY_COUNT];
+  sosFilter_filterBank(x, outputs);
+
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    float oldest = powerWindow[i][powerWindowIndex];
+    float newestSquare = outputs[i] * outputs[i];
+    powerWindow[i][powerWindowIndex] = outputs[i];
+    compensatedAdd(&currentPower[i], &powerCompensation[i],
+                   newestSquare - oldest * oldest);
+    compensatedAdd(&windowSum[i], &windowCompensation[i], newestSquare);
+  }
+
+  powerWindowIndex++;
+  // case the index reached the end of the window, so every window has been
+  // summed from scratch and the running powers are replaced
+  if (powerWindowIndex >= POWER_WINDOW_SIZE) {
+    powerWindowIndex = FOR_LOOP_START_VALUE;
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      currentPower[i] = windowSum[i];
+      powerCompensation[i] = windowCompensation[i];
+      windowSum[i] = INITIAL_VALUE;
+      windowCompensation[i] = INITIAL_VALUE;
+    }
+  }
+}
+
+// adds value to sum, carrying the rounding error in compensation. This relies
+// on the compiler not reassociating float math, so no -ffast-math
+static void compensatedAdd(float *sum, float *compensation, float value) {
+  float correctedValue = value - *compensation;
+  float updatedSum = *sum + correctedValue;
+  *compensation = (updatedSum - *sum) - correctedValue;
+  *sum = updatedSum;
+}
+
+// Returns the current power of the given filter.
+float floatFilter_getCurrentPowerValue(uint16_t filterNumber) {
+  return currentPower[filterNumber];
+}
+
+// Runs one test signal per player through this chain and the double chain
+// and prints the worst power errors and hit decision flips.
+void floatFilter_runAccuracyReport(double fudgeFactor) {
+  double worstPowerError[FILTER_FREQUENCY_COUNT];
+  uint32_t hitFlips = FOR_LOOP_START_VALUE;
+  filter_iirEngine_t selectedIirEngine = filter_getIirEngine();
+  filter_powerEngine_t selectedPowerEngine = filter_getPowerEngine();
+
+  filter_setIirEngine(FILTER_IIR_DIRECT_FORM);
+  filter_setPowerEngine(FILTER_POWER_IIR);
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    worstPowerError[i] = INITIAL_SUM_VALUE;
+  }
+  // one test signal per player frequency, so every filter sees its own tone
+  // as well as tones in its stopband
+  for (uint16_t player = FOR_LOOP_START_VALUE; player < FILTER_FREQUENCY_COUNT;
+       player++) {
+    hitFlips += compareWithDoubleChain(player, fudgeFactor, worstPowerError);
+  }
+
+  printf("float chain against double chain\n");
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    printf("  filter %d: worst relative power error %e\n", i,
+           worstPowerError[i]);
+  }
+  printf("hit decisions that differ: %u\n", (unsigned)hitFlips);
+  // puts back the caller's engines
+  filter_setIirEngine(selectedIirEngine);
+  filter_setPowerEngine(selectedPowerEngine);
+  filter_reset();
+}
+
+// runs the test signal for one player through both chains, updates the worst
+// power errors and returns the number of hit decisions that differ
+static uint32_t compareWithDoubleChain(uint16_t player, double fudgeFactor,
+                                       double worstPowerError[]) {
+  testSignal_t signal;
+  uint32_t decimatedCount = FOR_LOOP_START_VALUE;
+  uint32_t hitFlips = FOR_LOOP_START_VALUE;
+  testSignal_init(&signal, player, REPORT_ADC_RATE_FACTOR);
+
+  filter_reset();
+  floatFilter_init();
+
+  for (uint32_t start = FOR_LOOP_START_VALUE; start < REPORT_SAMPLE_COUNT;
+       start += REPORT_BLOCK_SIZE) {
+    uint32_t adcValues[REPORT_BLOCK_SIZE];
+    double doubleOutputs[REPORT_DECIMATED_BLOCK_SIZE];
+    float floatOutputs[REPORT_DECIMATED_BLOCK_SIZE];
+
+    for (uint32_t k = FOR_LOOP_START_VALUE; k < REPORT_BLOCK_SIZE; k++) {
+      uint32_t n = start + k;
+      bool burstOn =
+          ((n >= REPORT_LONG_BURST_START) && (n < REPORT_LONG_BURST_END)) ||
+          ((n >= REPORT_SHORT_BURST_START) && (n < REPORT_SHORT_BURST_END));
+      double x = testSignal_getSample(&signal, n, burstOn);
+      adcValues[k] = REPORT_ADC_CENTER + REPORT_ADC_FULL_SCALE * x;
+    }
+
+    uint32_t outputCount =
+        filter_decimateAdcBlock(adcValues, REPORT_BLOCK_SIZE, doubleOutputs);
+    floatFilter_decimateAdcBlock(adcValues, REPORT_BLOCK_SIZE, floatOutputs);
+
+    for (uint32_t n = FOR_LOOP_START_VALUE; n < outputCount; n++) {
+      double doublePowers[FILTER_FREQUENCY_COUNT];
+      double floatPowers[FILTER_FREQUENCY_COUNT];
+      filter_addNewFirOutput(doubleOutputs[n]);
+      filter_iirFilterBank();
+      floatFilter_filterBank(floatOutputs[n]);
+      decimatedCount++;
+
+      for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+           i++) {
+        doublePowers[i] = filter_computePower(i, false, false);
+        floatPowers[i] = floatFilter_getCurrentPowerValue(i);
+        // case the window is full, so the power is a whole 2000-sample sum
+        if (decimatedCount >= POWER_WINDOW_SIZE) {
+          double powerError =
+              fabs(floatPowers[i] - doublePowers[i]) / doublePowers[i];
+          worstPowerError[i] = fmax(worstPowerError[i], powerError);
+        }
+      }
+      // case the chains would make a different hit decision
+      if (testSignal_findHit(doublePowers, fudgeFactor) !=
+          testSignal_findHit(floatPowers, fudgeFactor)) {
+        hitFlips++;
+      }
+    }
+  }
+  return hitFlips;
+}
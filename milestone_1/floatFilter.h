@@ -0,0 +1,38 @@
+#ifndef FLOATFILTER_H_
+#define FLOATFILTER_H_
+
+#include <stdint.h>
+
+// float version of the whole filter chain: decimating FIR, the 10 IIR
+// filters and the 2000-sample power. Values are half the width of the double
+// chain in filter.c, which stays as the reference. The IIR filters are the
+// float biquads in sosFilter.c (the 10th order direct form needs double), so
+// this chain cannot run together with the FILTER_IIR_SOS_FLOAT engine.
+
+// Clears all filter state and powers.
+void floatFilter_init();
+
+// Scales and decimates a block of raw ADC values with the FIR filter. Writes
+// the decimated outputs to decimatedOutputs (which must hold count / 10 + 1
+// values) and returns how many there were. State carries across calls.
+uint32_t floatFilter_decimateAdcBlock(const uint32_t adcValues[],
+                                      uint32_t count,
+                                      float decimatedOutputs[]);
+
+// Runs one decimated sample through all 10 IIR filters and updates the power
+// of each.
+void floatFilter_filterBank(float x);
+
+// Returns the current power of the given filter.
+float floatFilter_getCurrentPowerValue(uint16_t filterNumber);
+
+// Runs one test signal per player through this chain and the double chain
+// in filter.c. Prints, for each filter, the worst relative power error once
+// the power window is full, and how many times the hit decision (which
+// player's power is above fudgeFactor times the median, if any) differs
+// between the chains.
+// Reinitializes both chains, and resets the double chain with the caller's
+// engines afterwards.
+void floatFilter_runAccuracyReport(double fudgeFactor);
+
+#endif /* FLOATFILTER_H_ */
@@ -0,0 +1,228 @@
+// Generated by generator/kernelGenerator.c from coef.h. Do not edit; run the
+// generator again instead.
+
+#include "generatedKernels.h"
+
+double generatedKernels_fir81Tap(const double x[]) {
+  double sum0 = 0.0;
+  double sum1 = 0.0;
+  double sum2 = 0.0;
+  double sum3 = 0.0;
+  sum0 += 1.1529944592540634e-06 * (x[0] + x[80]);
+  sum1 += 2.6712277317884253e-06 * (x[1] + x[79]);
+  sum2 += 5.4309336273155656e-06 * (x[2] + x[78]);
+  sum3 += 8.7762567686188491e-06 * (x[3] + x[77]);
+  sum0 += 1.1226836154252847e-05 * (x[4] + x[76]);
+  sum1 += 1.0058085255480807e-05 * (x[5] + x[75]);
+  sum2 += 1.4571810291260151e-06 * (x[6] + x[74]);
+  sum3 += -1.8704226590257607e-05 * (x[7] + x[73]);
+  sum0 += -5.3374862307522568e-05 * (x[8] + x[72]);
+  sum1 += -0.0001022231862672629 * (x[9] + x[71]);
+  sum2 += -0.00015934649799040823 * (x[10] + x[70]);
+  sum3 += -0.00021150546124520687 * (x[11] + x[69]);
+  sum0 += -0.00023779657904351634 * (x[12] + x[68]);
+  sum1 += -0.00021165486132856287 * (x[13] + x[67]);
+  sum2 += -0.00010575602874734894 * (x[14] + x[66]);
+  sum3 += 0.00010025689747723802 * (x[15] + x[65]);
+  sum0 += 0.00041018738166361809 * (x[16] + x[64]);
+  sum1 += 0.00080175984597097608 * (x[17] + x[63]);
+  sum2 += 0.00121983764541959 * (x[18] + x[62]);
+  sum3 += 0.0015753520901206888 * (x[19] + x[61]);
+  sum0 += 0.0017524830799290074 * (x[20] + x[60]);
+  sum1 += 0.0016253916109024401 * (x[21] + x[59]);
+  sum2 += 0.0010838448257451498 * (x[22] + x[58]);
+  sum3 += 6.4707687698063482e-05 * (x[23] + x[57]);
+  sum0 += -0.0014160012432694255 * (x[24] + x[56]);
+  sum1 += -0.0032373889210712678 * (x[25] + x[55]);
+  sum2 += -0.0051615692289410115 * (x[26] + x[54]);
+  sum3 += -0.0068411988314185795 * (x[27] + x[53]);
+  sum0 += -0.0078498836142953023 * (x[28] + x[52]);
+  sum1 += -0.0077345621476575949 * (x[29] + x[51]);
+  sum2 += -0.006084297419105658 * (x[30] + x[50]);
+  sum3 += -0.002605619774931896 * (x[31] + x[49]);
+  sum0 += 0.0028083352198431926 * (x[32] + x[48]);
+  sum1 += 0.010028339640999705 * (x[33] + x[47]);
+  sum2 += 0.018670736665773312 * (x[34] + x[46]);
+  sum3 += 0.028117285724061362 * (x[35] + x[45]);
+  sum0 += 0.037573905241693108 * (x[36] + x[44]);
+  sum1 += 0.046162004675147673 * (x[37] + x[43]);
+  sum2 += 0.053029742573703222 * (x[38] + x[42]);
+  sum3 += 0.057466189941880554 * (x[39] + x[41]);
+  sum0 += 0.058999999999999997 * x[40];
+  // 41 multiplies
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+void generatedKernels_iir10ChannelBank(const double y[], const double *const z[],
+                                        double outputs[]) {
+  double numerator0_0 = 0.0;
+  double numerator0_1 = 0.0;
+  double numerator0_2 = 0.0;
+  double numerator0_3 = 0.0;
+  numerator0_0 += 9.0928661148194738e-10 * (y[0] - y[10]);
+  numerator0_1 += -4.5464330574097372e-09 * (y[2] - y[8]);
+  numerator0_2 += 9.0928661148194745e-09 * (y[4] - y[6]);
+  // 3 multiplies
+  double numerator0 = (numerator0_0 + numerator0_1) + (numerator0_2 + numerator0_3);
+
+  double feedback0_0 = 0.0;
+  double feedback0_1 = 0.0;
+  double feedback0_2 = 0.0;
+  double feedback0_3 = 0.0;
+  feedback0_0 += -5.9637727070164015 * z[0][0];
+  feedback0_1 += 0.90332828533799547 * z[0][9];
+  feedback0_2 += 19.125339333078248 * z[0][1];
+  feedback0_3 += -5.4979061224867651 * z[0][8];
+  feedback0_0 += -40.341474540744173 * z[0][2];
+  feedback0_1 += 17.993533279581058 * z[0][7];
+  feedback0_2 += 61.537466875368821 * z[0][3];
+  feedback0_3 += -38.73379286256629 * z[0][6];
+  feedback0_0 += -70.019717951472188 * z[0][4];
+  feedback0_1 += 60.298814235238872 * z[0][5];
+  outputs[0] = numerator0 - ((feedback0_0 + feedback0_1) + (feedback0_2 + feedback0_3));
+
+  double feedback1_0 = 0.0;
+  double feedback1_1 = 0.0;
+  double feedback1_2 = 0.0;
+  double feedback1_3 = 0.0;
+  feedback1_0 += -4.6377947119071505 * z[1][0];
+  feedback1_1 += 0.90332828533800569 * z[1][9];
+  feedback1_2 += 13.502215749461598 * z[1][1];
+  feedback1_3 += -4.2755083391143689 * z[1][8];
+  feedback1_0 += -26.155952405269829 * z[1][2];
+  feedback1_1 += 12.703182701888142 * z[1][7];
+  feedback1_2 += 38.589668330738476 * z[1][3];
+  feedback1_3 += -25.113598088113893 * z[1][6];
+  feedback1_0 += -43.038990303252795 * z[1][4];
+  feedback1_1 += 37.812927599537275 * z[1][5];
+  outputs[1] = numerator0 - ((feedback1_0 + feedback1_1) + (feedback1_2 + feedback1_3));
+
+  double feedback2_0 = 0.0;
+  double feedback2_1 = 0.0;
+  double feedback2_2 = 0.0;
+  double feedback2_3 = 0.0;
+  feedback2_0 += -3.0591317915750973 * z[2][0];
+  feedback2_1 += 0.90332828533800258 * z[2][9];
+  feedback2_2 += 8.6417489609637634 * z[2][1];
+  feedback2_3 += -2.8201643879900606 * z[2][8];
+  feedback2_0 += -14.27879025380887 * z[2][2];
+  feedback2_1 += 8.1303553577931904 * z[2][7];
+  feedback2_2 += 21.30226828330435 * z[2][3];
+  feedback2_3 += -13.709764520609433 * z[2][6];
+  feedback2_0 += -22.193853972079282 * z[2][4];
+  feedback2_1 += 20.873499791105495 * z[2][5];
+  outputs[2] = numerator0 - ((feedback2_0 + feedback2_1) + (feedback2_2 + feedback2_3));
+
+  double feedback3_0 = 0.0;
+  double feedback3_1 = 0.0;
+  double feedback3_2 = 0.0;
+  double feedback3_3 = 0.0;
+  feedback3_0 += -1.4071749185996785 * z[3][0];
+  feedback3_1 += 0.90332828533800258 * z[3][9];
+  feedback3_2 += 5.6904141470697605 * z[3][1];
+  feedback3_3 += -1.2972519209655651 * z[3][8];
+  feedback3_0 += -5.7374718273676475 * z[3][2];
+  feedback3_1 += 5.3536787286077807 * z[3][7];
+  feedback3_2 += 11.95802836286893 * z[3][3];
+  feedback3_3 += -5.508829087699886 * z[3][6];
+  feedback3_0 += -8.5435280598354932 * z[3][4];
+  feedback3_1 += 11.717345583835993 * z[3][5];
+  outputs[3] = numerator0 - ((feedback3_0 + feedback3_1) + (feedback3_2 + feedback3_3));
+
+  double feedback4_0 = 0.0;
+  double feedback4_1 = 0.0;
+  double feedback4_2 = 0.0;
+  double feedback4_3 = 0.0;
+  feedback4_0 += 0.82010906117760696 * z[4][0];
+  feedback4_1 += 0.90332828533800136 * z[4][9];
+  feedback4_2 += 5.1673756579268639 * z[4][1];
+  feedback4_3 += 0.75604535083145297 * z[4][8];
+  feedback4_0 += 3.2580350909221076 * z[4][2];
+  feedback4_1 += 4.8615933365572053 * z[4][7];
+  feedback4_2 += 10.392903763919204 * z[4][3];
+  feedback4_3 += 3.1282000712126905 * z[4][6];
+  feedback4_0 += 4.8101776408669306 * z[4][4];
+  feedback4_1 += 10.183724507092521 * z[4][5];
+  outputs[4] = numerator0 - ((feedback4_0 + feedback4_1) + (feedback4_2 + feedback4_3));
+
+  double feedback5_0 = 0.0;
+  double feedback5_1 = 0.0;
+  double feedback5_2 = 0.0;
+  double feedback5_3 = 0.0;
+  feedback5_0 += 2.7080869856154512 * z[5][0];
+  feedback5_1 += 0.90332828533800436 * z[5][9];
+  feedback5_2 += 7.8319071217995688 * z[5][1];
+  feedback5_3 += 2.4965418284511904 * z[5][8];
+  feedback5_0 += 12.201607990980744 * z[5][2];
+  feedback5_1 += 7.3684394621253499 * z[5][7];
+  feedback5_2 += 18.65150044368162 * z[5][3];
+  feedback5_3 += 11.715361303018897 * z[5][6];
+  feedback5_0 += 18.758157568004549 * z[5][4];
+  feedback5_1 += 18.276088095999022 * z[5][5];
+  outputs[5] = numerator0 - ((feedback5_0 + feedback5_1) + (feedback5_2 + feedback5_3));
+
+  double feedback6_0 = 0.0;
+  double feedback6_1 = 0.0;
+  double feedback6_2 = 0.0;
+  double feedback6_3 = 0.0;
+  feedback6_0 += 4.9479835250075892 * z[6][0];
+  feedback6_1 += 0.90332828533799958 * z[6][9];
+  feedback6_2 += 14.691607003177602 * z[6][1];
+  feedback6_3 += 4.5614664160654357 * z[6][8];
+  feedback6_0 += 29.08241477210106 * z[6][2];
+  feedback6_1 += 13.82218651047101 * z[6][7];
+  feedback6_2 += 43.179839108869331 * z[6][3];
+  feedback6_3 += 27.923434247706432 * z[6][6];
+  feedback6_0 += 48.440791644688879 * z[6][4];
+  feedback6_1 += 42.310703962394342 * z[6][5];
+  outputs[6] = numerator0 - ((feedback6_0 + feedback6_1) + (feedback6_2 + feedback6_3));
+
+  double feedback7_0 = 0.0;
+  double feedback7_1 = 0.0;
+  double feedback7_2 = 0.0;
+  double feedback7_3 = 0.0;
+  feedback7_0 += 6.1701893352279846 * z[7][0];
+  feedback7_1 += 0.90332828533799803 * z[7][9];
+  feedback7_2 += 20.127225876810336 * z[7][1];
+  feedback7_3 += 5.6881982915180291 * z[7][8];
+  feedback7_0 += 42.974193398071684 * z[7][2];
+  feedback7_1 += 18.936128791950534 * z[7][7];
+  feedback7_2 += 65.958045321253451 * z[7][3];
+  feedback7_3 += 41.261591079244127 * z[7][6];
+  feedback7_0 += 75.230437667866596 * z[7][4];
+  feedback7_1 += 64.630411355739852 * z[7][5];
+  outputs[7] = numerator0 - ((feedback7_0 + feedback7_1) + (feedback7_2 + feedback7_3));
+
+  double feedback8_0 = 0.0;
+  double feedback8_1 = 0.0;
+  double feedback8_2 = 0.0;
+  double feedback8_3 = 0.0;
+  feedback8_0 += 7.4092912870072398 * z[8][0];
+  feedback8_1 += 0.90332828533799969 * z[8][9];
+  feedback8_2 += 26.857944460290135 * z[8][1];
+  feedback8_3 += 6.8305064480743081 * z[8][8];
+  feedback8_0 += 61.578787811202247 * z[8][2];
+  feedback8_1 += 25.268527576524203 * z[8][7];
+  feedback8_2 += 98.258255839887312 * z[8][3];
+  feedback8_3 += 59.124742025776392 * z[8][6];
+  feedback8_0 += 113.59460153696298 * z[8][4];
+  feedback8_1 += 96.280452143026082 * z[8][5];
+  outputs[8] = numerator0 - ((feedback8_0 + feedback8_1) + (feedback8_2 + feedback8_3));
+
+  double feedback9_0 = 0.0;
+  double feedback9_1 = 0.0;
+  double feedback9_2 = 0.0;
+  double feedback9_3 = 0.0;
+  feedback9_0 += 8.5743055776347692 * z[9][0];
+  feedback9_1 += 0.90332828533799636 * z[9][9];
+  feedback9_2 += 34.306584753117889 * z[9][1];
+  feedback9_3 += 7.9045143816244696 * z[9][8];
+  feedback9_0 += 84.035290411037053 * z[9][2];
+  feedback9_1 += 32.276361903872115 * z[9][7];
+  feedback9_2 += 139.28510844056814 * z[9][3];
+  feedback9_3 += 80.686288623299745 * z[9][6];
+  feedback9_0 += 163.0511541816162 * z[9][4];
+  feedback9_1 += 136.48147221895786 * z[9][5];
+  outputs[9] = numerator0 - ((feedback9_0 + feedback9_1) + (feedback9_2 + feedback9_3));
+
+}
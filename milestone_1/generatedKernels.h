@@ -0,0 +1,22 @@
+// Generated by generator/kernelGenerator.c from coef.h. Do not edit; run the
+// generator again instead.
+
+#ifndef GENERATEDKERNELS_H_
+#define GENERATEDKERNELS_H_
+
+// the table sizes the kernels were generated for
+#define GENERATED_KERNELS_FIR_TAP_COUNT 81
+#define GENERATED_KERNELS_IIR_CHANNEL_COUNT 10
+#define GENERATED_KERNELS_IIR_B_COEFFICIENT_COUNT 11
+#define GENERATED_KERNELS_IIR_A_COEFFICIENT_COUNT 11
+
+// Returns the FIR output for the 81 samples in x, oldest first.
+double generatedKernels_fir81Tap(const double x[]);
+
+// Runs one step of all 10 IIR filters. y holds the newest 11 filter inputs and
+// z[i] the newest 10 outputs of filter i, newest first. The new output of
+// every filter is written to outputs; the histories are left to the caller.
+void generatedKernels_iir10ChannelBank(const double y[], const double *const z[],
+                                        double outputs[]);
+
+#endif /* GENERATEDKERNELS_H_ */
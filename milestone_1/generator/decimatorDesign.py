@@ -0,0 +1,138 @@
+# Host script that designs the FIR tables of the two multistage decimators
+# in multistageDecimator.c and writes them into coef.h in place of the ones
+# there. Both decimators turn the 100 kHz ADC samples into the 10 kHz input
+# of the IIR filters with the 0.5 passband gain of the 81-tap FIR, keeping
+# the player band (1.47 to 4.17 kHz) flat and rejecting what would alias
+# onto it.
+#
+# cicCompensatorCoefficients: 15-tap FIR at 10 kHz behind the 4th order CIC
+#   decimating by 10. A least squares fit of 0.5 over the CIC response on
+#   0 to 4.3 kHz (weight 1), and of 0 on 4.8 to 5 kHz (weight 0.3), which
+#   flattens the CIC droop across the player band.
+# halfBandCoefficients: 11-tap half-band FIR at 100 kHz decimating by 2. A
+#   Hamming windowed sinc cut off at a quarter of the rate, with the odd taps
+#   set to exactly 0 and the others scaled so the center tap is 0.5 and the
+#   rest add up to 0.5, which makes the DC gain 1.
+# halfBandSecondStageCoefficients: 31-tap FIR at 50 kHz decimating by 5. An
+#   equiripple (Parks-McClellan) design with a gain of 0.5 on 0 to 4.3 kHz and
+#   0 on 6 to 25 kHz, equally weighted, made exactly symmetric.
+#
+# Run it again after changing a design. From milestone_1/generator, with
+# numpy and scipy installed (pip install numpy scipy):
+#   python3 decimatorDesign.py ../../coef.h
+
+import sys
+
+import numpy as np
+from scipy import signal
+
+ADC_RATE_HZ = 100000
+DECIMATED_RATE_HZ = 10000
+HALF_BAND_OUTPUT_RATE_HZ = 50000
+
+# the end of the band the player frequencies are in, with some margin
+PASSBAND_EDGE_HZ = 4300
+PASSBAND_GAIN = 0.5
+
+CIC_DECIMATION = 10
+CIC_ORDER = 4
+COMPENSATOR_TAP_COUNT = 15
+COMPENSATOR_GRID_POINTS = 2001
+COMPENSATOR_STOPBAND_START_HZ = 4800
+COMPENSATOR_STOPBAND_WEIGHT = 0.3
+# keeps sin(R x) / (R sin x) from dividing by 0 at DC, where it is 1 anyway
+COMPENSATOR_DIVISION_GUARD = 1e-300
+
+HALF_BAND_TAP_COUNT = 11
+HALF_BAND_CUTOFF_HZ = ADC_RATE_HZ / 4
+HALF_BAND_CENTER_TAP = 0.5
+HALF_BAND_SIDE_SUM = 0.5
+
+SECOND_STAGE_TAP_COUNT = 31
+SECOND_STAGE_STOPBAND_START_HZ = 6000
+
+# coef.h has Windows line endings
+NEWLINE = "\r\n"
+# format that reads back as the same double
+CONSTANT_FORMAT = "%.16e"
+
+TABLE_END = "};"
+
+
+# returns the magnitude of the CIC response at the given frequencies
+def cicResponse(frequencies):
+    x = np.pi * frequencies / ADC_RATE_HZ
+    return np.where(x == 0, 1.0,
+                    np.abs(np.sin(CIC_DECIMATION * x) /
+                           (CIC_DECIMATION * np.sin(x) +
+                            COMPENSATOR_DIVISION_GUARD)))**CIC_ORDER
+
+
+def designCompensator():
+    halfLength = (COMPENSATOR_TAP_COUNT - 1) // 2
+    nyquist = DECIMATED_RATE_HZ / 2
+    f = np.linspace(0, nyquist, COMPENSATOR_GRID_POINTS)
+    weight = np.where(f <= PASSBAND_EDGE_HZ, 1.0,
+                      np.where(f >= COMPENSATOR_STOPBAND_START_HZ,
+                               COMPENSATOR_STOPBAND_WEIGHT, 0.0))
+    desired = np.where(f <= PASSBAND_EDGE_HZ,
+                       PASSBAND_GAIN / cicResponse(f), 0.0)
+    # a symmetric odd length FIR is c0 + sum of 2 ck cos(2 pi f k / rate)
+    basis = np.column_stack(
+        [np.ones_like(f)] +
+        [2 * np.cos(2 * np.pi * f / DECIMATED_RATE_HZ * k)
+         for k in range(1, halfLength + 1)])
+    c = np.linalg.lstsq(basis * weight[:, None], desired * weight,
+                        rcond=None)[0]
+    return np.concatenate([c[:0:-1], c])
+
+
+def designHalfBand():
+    taps = signal.firwin(HALF_BAND_TAP_COUNT, HALF_BAND_CUTOFF_HZ,
+                         fs=ADC_RATE_HZ)
+    center = HALF_BAND_TAP_COUNT // 2
+    # zeroes every other tap from the second one, center included, then puts
+    # the center back
+    taps[1::2] = 0
+    side = taps.sum() - taps[center]
+    taps = taps * HALF_BAND_SIDE_SUM / side
+    taps[center] = HALF_BAND_CENTER_TAP
+    return taps
+
+
+def designSecondStage():
+    taps = signal.remez(SECOND_STAGE_TAP_COUNT,
+                        [0, PASSBAND_EDGE_HZ, SECOND_STAGE_STOPBAND_START_HZ,
+                         HALF_BAND_OUTPUT_RATE_HZ / 2],
+                        [PASSBAND_GAIN, 0], weight=[1, 1],
+                        fs=HALF_BAND_OUTPUT_RATE_HZ)
+    return (taps + taps[::-1]) / 2
+
+
+# returns the text with the values of the named table replaced, keeping its
+# declaration
+def replaceTable(text, name, taps):
+    declaration = text.index("const static double " + name + "[")
+    start = text.index("{", declaration) + 1
+    end = text.index(TABLE_END, start)
+    values = (", " + NEWLINE).join(CONSTANT_FORMAT % v for v in taps)
+    return text[:start] + NEWLINE + values + text[end:]
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: python3 decimatorDesign.py <path to coef.h>")
+    path = sys.argv[1]
+    with open(path, newline="") as file:
+        text = file.read()
+    text = replaceTable(text, "cicCompensatorCoefficients",
+                        designCompensator())
+    text = replaceTable(text, "halfBandCoefficients", designHalfBand())
+    text = replaceTable(text, "halfBandSecondStageCoefficients",
+                        designSecondStage())
+    with open(path, "w", newline="") as file:
+        file.write(text)
+
+
+if __name__ == "__main__":
+    main()
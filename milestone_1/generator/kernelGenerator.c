@@ -0,0 +1,257 @@
+// Host program that turns the coefficient tables in coef.h into the fully
+// unrolled kernels in generatedKernels.h and generatedKernels.c. Every
+// constant is written into the code, taps that are exactly zero are left out,
+// and taps that match (or are the negative of) their mirror share one
+// multiply. Rows of b coefficients that are the same polynomial are computed
+// once for the whole bank.
+//
+// Run it again whenever coef.h changes. From milestone_1/generator:
+//   gcc -std=gnu11 -I../.. kernelGenerator.c -o kernelGenerator
+//   ./kernelGenerator ../generatedKernels.h ../generatedKernels.c
+
+#include "coef.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INDEX_OFFSET 1
+#define HEADER_PATH_ARGUMENT 1
+#define SOURCE_PATH_ARGUMENT 2
+#define ARGUMENT_COUNT 3
+#define EXIT_OK 0
+#define EXIT_FAILED 1
+
+// the terms of a kernel are spread over this many sums so the adds do not
+// all wait on each other
+#define ACCUMULATOR_COUNT 4
+
+// largest difference allowed between b coefficients of two rows for them to
+// still count as the same numerator, same as filter.c
+#define SHARED_NUMERATOR_TOLERANCE 1e-18
+
+// printf format that reads back as the same double
+#define CONSTANT_FORMAT "%.17g"
+
+// how a tap relates to its mirror
+typedef enum { TAP_UNIQUE, TAP_SYMMETRIC, TAP_ANTISYMMETRIC } tapPairing_t;
+
+// number of multiplies written by the last call to emitSum
+static uint16_t emittedMultiplyCount;
+
+// writes the header
+static void emitHeader(FILE *file);
+
+// writes the source file
+static void emitSource(FILE *file);
+
+// writes statements that add taps[k] * input[k] for every k into the
+// accumulators named prefix0 to prefix3, after declaring them
+static void emitSum(FILE *file, const char *prefix, const char *input,
+                    const double taps[], uint16_t tapCount);
+
+// writes one term into the next accumulator
+static void emitTerm(FILE *file, const char *prefix, uint16_t *accumulator,
+                     double tap, const char *operand);
+
+// returns how tap k relates to its mirror
+static tapPairing_t getPairing(const double taps[], uint16_t tapCount,
+                               uint16_t k);
+
+// returns the first row of iirBCoefficientConstants that is the same
+// polynomial as the given row
+static uint16_t getNumeratorRow(uint16_t filterNumber);
+
+int main(int argc, char *argv[]) {
+  // case the output paths were not given
+  if (argc != ARGUMENT_COUNT) {
+    fprintf(stderr, "usage: %s generatedKernels.h generatedKernels.c\n",
+            argv[FOR_LOOP_START_VALUE]);
+    return EXIT_FAILED;
+  }
+  FILE *header = fopen(argv[HEADER_PATH_ARGUMENT], "w");
+  FILE *source = fopen(argv[SOURCE_PATH_ARGUMENT], "w");
+  // case either file could not be opened
+  if ((header == NULL) || (source == NULL)) {
+    fprintf(stderr, "could not open the output files\n");
+    return EXIT_FAILED;
+  }
+  emitHeader(header);
+  emitSource(source);
+  fclose(header);
+  fclose(source);
+  return EXIT_OK;
+}
+
+// writes the header
+static void emitHeader(FILE *file) {
+  fprintf(file, "// Generated by generator/kernelGenerator.c from coef.h. Do "
+                "not edit; run the\n// generator again instead.\n\n");
+  fprintf(file, "#ifndef GENERATEDKERNELS_H_\n#define GENERATEDKERNELS_H_\n\n");
+  fprintf(file, "// the table sizes the kernels were generated for\n");
+  fprintf(file, "#define GENERATED_KERNELS_FIR_TAP_COUNT %d\n",
+          FIR_FILTER_TAP_COUNT);
+  fprintf(file, "#define GENERATED_KERNELS_IIR_CHANNEL_COUNT %d\n",
+          FILTER_FREQUENCY_COUNT);
+  fprintf(file, "#define GENERATED_KERNELS_IIR_B_COEFFICIENT_COUNT %d\n",
+          IIR_B_COEFFICIENT_COUNT);
+  fprintf(file, "#define GENERATED_KERNELS_IIR_A_COEFFICIENT_COUNT %d\n\n",
+          IIR_A_COEFFICIENT_COUNT);
+  fprintf(file,
+          "// Returns the FIR output for the %d samples in x, oldest first.\n",
+          FIR_FILTER_TAP_COUNT);
+  fprintf(file, "double generatedKernels_fir%dTap(const double x[]);\n\n",
+          FIR_FILTER_TAP_COUNT);
+  fprintf(file,
+          "// Runs one step of all %d IIR filters. y holds the newest %d "
+          "filter inputs and\n// z[i] the newest %d outputs of filter i, "
+          "newest first. The new output of\n// every filter is written to "
+          "outputs; the histories are left to the caller.\n",
+          FILTER_FREQUENCY_COUNT, IIR_B_COEFFICIENT_COUNT,
+          IIR_A_COEFFICIENT_COUNT - INDEX_OFFSET);
+  fprintf(file,
+          "void generatedKernels_iir%dChannelBank(const double y[], const "
+          "double *const z[],\n                                        double "
+          "outputs[]);\n\n",
+          FILTER_FREQUENCY_COUNT);
+  fprintf(file, "#endif /* GENERATEDKERNELS_H_ */\n");
+}
+
+// writes the source file
+static void emitSource(FILE *file) {
+  char name[32];
+  fprintf(file, "// Generated by generator/kernelGenerator.c from coef.h. Do "
+                "not edit; run the\n// generator again instead.\n\n");
+  fprintf(file, "#include \"generatedKernels.h\"\n\n");
+
+  // the FIR takes the oldest sample first, so tap k multiplies x[80 - k]
+  fprintf(file, "double generatedKernels_fir%dTap(const double x[]) {\n",
+          FIR_FILTER_TAP_COUNT);
+  double reversedTaps[FIR_FILTER_TAP_COUNT];
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < FIR_FILTER_TAP_COUNT; k++) {
+    reversedTaps[k] = firCoefficients[FIR_FILTER_TAP_COUNT - INDEX_OFFSET - k];
+  }
+  emitSum(file, "sum", "x", reversedTaps, FIR_FILTER_TAP_COUNT);
+  fprintf(file, "  // %d multiplies\n", emittedMultiplyCount);
+  fprintf(file, "  return (sum0 + sum1) + (sum2 + sum3);\n}\n\n");
+
+  fprintf(file,
+          "void generatedKernels_iir%dChannelBank(const double y[], const "
+          "double *const z[],\n                                        double "
+          "outputs[]) {\n",
+          FILTER_FREQUENCY_COUNT);
+  // one numerator per distinct row of b coefficients
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    // case an earlier row already has this numerator
+    if (getNumeratorRow(i) != i) {
+      continue;
+    }
+    snprintf(name, sizeof(name), "numerator%d_", i);
+    emitSum(file, name, "y", iirBCoefficientConstants[i],
+            IIR_B_COEFFICIENT_COUNT);
+    fprintf(file, "  // %d multiplies\n", emittedMultiplyCount);
+    fprintf(file,
+            "  double numerator%d = (numerator%d_0 + numerator%d_1) + "
+            "(numerator%d_2 + numerator%d_3);\n\n",
+            i, i, i, i, i);
+  }
+  // the a coefficients in coef.h skip the leading 1, so a[k] multiplies the
+  // output k + 1 samples back, which is z[i][k]
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    char input[16];
+    snprintf(name, sizeof(name), "feedback%d_", i);
+    snprintf(input, sizeof(input), "z[%d]", i);
+    emitSum(file, name, input, iirACoefficientConstants[i],
+            IIR_A_COEFFICIENT_COUNT - INDEX_OFFSET);
+    fprintf(file,
+            "  outputs[%d] = numerator%d - ((feedback%d_0 + feedback%d_1) + "
+            "(feedback%d_2 + feedback%d_3));\n\n",
+            i, getNumeratorRow(i), i, i, i, i);
+  }
+  fprintf(file, "}\n");
+}
+
+// writes statements that add taps[k] * input[k] for every k into the
+// accumulators named prefix0 to prefix3, after declaring them
+static void emitSum(FILE *file, const char *prefix, const char *input,
+                    const double taps[], uint16_t tapCount) {
+  uint16_t accumulator = FOR_LOOP_START_VALUE;
+  char operand[64];
+  emittedMultiplyCount = FOR_LOOP_START_VALUE;
+  for (uint16_t a = FOR_LOOP_START_VALUE; a < ACCUMULATOR_COUNT; a++) {
+    fprintf(file, "  double %s%d = 0.0;\n", prefix, a);
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < (tapCount + INDEX_OFFSET) / 2;
+       k++) {
+    uint16_t mirror = tapCount - INDEX_OFFSET - k;
+    tapPairing_t pairing = getPairing(taps, tapCount, k);
+    // case this is the middle tap, which has no partner
+    if (mirror == k) {
+      snprintf(operand, sizeof(operand), "%s[%d]", input, k);
+      emitTerm(file, prefix, &accumulator, taps[k], operand);
+    }
+    // case the pair shares a multiply
+    else if (pairing != TAP_UNIQUE) {
+      snprintf(operand, sizeof(operand), "(%s[%d] %c %s[%d])", input, k,
+               (pairing == TAP_SYMMETRIC) ? '+' : '-', input, mirror);
+      emitTerm(file, prefix, &accumulator, taps[k], operand);
+    }
+    // otherwise both taps are written on their own
+    else {
+      snprintf(operand, sizeof(operand), "%s[%d]", input, k);
+      emitTerm(file, prefix, &accumulator, taps[k], operand);
+      snprintf(operand, sizeof(operand), "%s[%d]", input, mirror);
+      emitTerm(file, prefix, &accumulator, taps[mirror], operand);
+    }
+  }
+}
+
+// writes one term into the next accumulator
+static void emitTerm(FILE *file, const char *prefix, uint16_t *accumulator,
+                     double tap, const char *operand) {
+  // case the tap is exactly zero, so the term is left out
+  if (tap == 0.0) {
+    return;
+  }
+  fprintf(file, "  %s%d += " CONSTANT_FORMAT " * %s;\n", prefix, *accumulator,
+          tap, operand);
+  emittedMultiplyCount++;
+  *accumulator = (*accumulator + INDEX_OFFSET) % ACCUMULATOR_COUNT;
+}
+
+// returns how tap k relates to its mirror
+static tapPairing_t getPairing(const double taps[], uint16_t tapCount,
+                               uint16_t k) {
+  double mirrorTap = taps[tapCount - INDEX_OFFSET - k];
+  // case the pair is the same tap
+  if (taps[k] == mirrorTap) {
+    return TAP_SYMMETRIC;
+  }
+  // case the pair is the same tap with opposite signs
+  if (taps[k] == -mirrorTap) {
+    return TAP_ANTISYMMETRIC;
+  }
+  return TAP_UNIQUE;
+}
+
+// returns the first row of iirBCoefficientConstants that is the same
+// polynomial as the given row
+static uint16_t getNumeratorRow(uint16_t filterNumber) {
+  for (uint16_t row = FOR_LOOP_START_VALUE; row < filterNumber; row++) {
+    bool same = true;
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < IIR_B_COEFFICIENT_COUNT; k++) {
+      double difference = iirBCoefficientConstants[filterNumber][k] -
+                          iirBCoefficientConstants[row][k];
+      // case one coefficient differs, so this is another polynomial
+      if (fabs(difference) > SHARED_NUMERATOR_TOLERANCE) {
+        same = false;
+      }
+    }
+    if (same) {
+      return row;
+    }
+  }
+  return filterNumber;
+}
@@ -0,0 +1,137 @@
+# Host script that splits the IIR filters in coef.h into the parallel form
+# parallelIir.c runs: a direct term plus one section per conjugate pole pair,
+#   H(z) = d + sum of (b0 + b1 z^-1) / (1 + a1 z^-1 + a2 z^-2),
+# and writes the iirParallelDirectTerms and iirParallelSections tables back
+# into coef.h in place of the ones there.
+#
+# The poles of each filter cluster tightly around its center frequency, so
+# the partial fraction residues are differences of nearly equal products that
+# lose most of their digits in double. Everything is computed with 50 digits
+# (mpmath) from the double values in iirACoefficientConstants and
+# iirBCoefficientConstants, and only the results are rounded to double.
+#
+# Run it again whenever the IIR rows of coef.h change. From
+# milestone_1/generator, with mpmath installed (pip install mpmath):
+#   python3 parallelSections.py ../../coef.h
+
+import re
+import sys
+
+import mpmath
+
+DIGITS = 50
+ROOT_STEPS = 200
+ROOT_EXTRA_PRECISION = 200
+
+FILTER_COUNT = 10
+A_COEFFICIENT_COUNT = 10
+B_COEFFICIENT_COUNT = 11
+
+# coef.h has Windows line endings
+NEWLINE = "\r\n"
+# format that reads back as the same double
+CONSTANT_FORMAT = "%.16e"
+
+BLOCK_START = "// parallel form of the IIR filters above"
+BLOCK_END_TABLE = "const static double iirParallelSections"
+BLOCK_END = "};"
+
+COMMENT = [
+    "// parallel form of the IIR filters above: H(z) = d + sum of",
+    "// (b0 + b1 z^-1) / (1 + a1 z^-1 + a2 z^-2) over the sections, {b0, b1, a1, a2}",
+    "// per section. Each section is one conjugate pole pair from the roots of",
+    "// iirACoefficientConstants with its partial fraction residue, computed in",
+    "// 50 digit precision so the residues of the clustered poles stay accurate.",
+    "// Written by milestone_1/generator/parallelSections.py, which has to be run",
+    "// again whenever the IIR rows above change",
+]
+
+
+# returns the numbers of a coef.h table, row by row
+def readTable(text, name, rowLength):
+    start = text.index(name)
+    body = text[text.index("{", start) + 1:text.index(BLOCK_END, start)]
+    values = [float(v) for v in re.findall(r"-?\d+\.\d+e[-+]\d+", body)]
+    return [values[i:i + rowLength] for i in range(0, len(values), rowLength)]
+
+
+# returns the direct term and the {b0, b1, a1, a2} sections of one filter
+def splitFilter(aRow, bRow):
+    # the denominator 1 + a1 z^-1 + ... + a10 z^-10 and the numerator, with
+    # the doubles taken exactly
+    a = [mpmath.mpf(1)] + [mpmath.mpf(v) for v in aRow]
+    b = [mpmath.mpf(v) for v in bRow]
+    # the numerator has the same degree as the denominator, so a constant
+    # comes out first and leaves a proper fraction
+    direct = b[-1] / a[-1]
+    remainder = [b[k] - direct * a[k] for k in range(len(b))]
+    # the poles are the roots of z^10 + a1 z^9 + ... + a10
+    poles = mpmath.polyroots(a, maxsteps=ROOT_STEPS,
+                             extraprec=ROOT_EXTRA_PRECISION)
+    sections = []
+    for i, pole in enumerate(poles):
+        # case this is the lower pole of a pair, which its upper one covers
+        if mpmath.im(pole) <= 0:
+            continue
+        # residue of the pole in z^-1: the remainder over the other factors
+        # (1 - p z^-1), at z^-1 = 1 / pole
+        w = 1 / pole
+        numerator = sum(remainder[k] * w**k for k in range(len(remainder)))
+        denominator = mpmath.mpf(1)
+        for j, other in enumerate(poles):
+            if j != i:
+                denominator *= 1 - other * w
+        residue = numerator / denominator
+        # the pole pair and its conjugate residues as one real section
+        sections.append([
+            2 * mpmath.re(residue),
+            -2 * mpmath.re(residue * mpmath.conj(pole)),
+            -2 * mpmath.re(pole),
+            abs(pole)**2,
+        ])
+    return direct, sections
+
+
+def formatConstant(value):
+    return CONSTANT_FORMAT % float(value)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: python3 parallelSections.py <path to coef.h>")
+    path = sys.argv[1]
+    mpmath.mp.dps = DIGITS
+    with open(path, newline="") as file:
+        text = file.read()
+
+    aRows = readTable(text, "iirACoefficientConstants", A_COEFFICIENT_COUNT)
+    bRows = readTable(text, "iirBCoefficientConstants", B_COEFFICIENT_COUNT)
+    directTerms = []
+    sectionRows = []
+    for i in range(FILTER_COUNT):
+        direct, sections = splitFilter(aRows[i], bRows[i])
+        directTerms.append(formatConstant(direct))
+        sectionRows.append("{" + ("," + NEWLINE + " ").join(
+            "{" + ", ".join(formatConstant(v) for v in section) + "}"
+            for section in sections) + "}")
+
+    lines = COMMENT + [
+        "const static double iirParallelDirectTerms[FILTER_FREQUENCY_COUNT] = {",
+        (", " + NEWLINE).join(directTerms) + "};",
+        "",
+        "const static double iirParallelSections[FILTER_FREQUENCY_COUNT]"
+        "[IIR_PARALLEL_SECTION_COUNT][IIR_PARALLEL_COEFFICIENT_COUNT] = {",
+        ("," + NEWLINE).join(sectionRows),
+        BLOCK_END,
+    ]
+    block = NEWLINE.join(lines)
+
+    # replaces the block from its comment to the end of the sections table
+    start = text.index(BLOCK_START)
+    end = text.index(BLOCK_END, text.index(BLOCK_END_TABLE)) + len(BLOCK_END)
+    with open(path, "w", newline="") as file:
+        file.write(text[:start] + block + text[end:])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#include "goertzel.h"
+#include "filter.h"
+#include "filterModes.h"
+#include "intervalTimer.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+
+#define BLOCK_SIZE FILTER_INPUT_PULSE_WIDTH
+#define BLOCK_COUNT 4
+#define BLOCK_STAGGER (BLOCK_SIZE / BLOCK_COUNT)
+
+// |X|^2 of a tone of amplitude A over the block is (A * 2000 / 2)^2, and the
+// 2000-sample power of the same tone is 2000 * A^2 / 2
+#define POWER_SCALE (2.0 / BLOCK_SIZE)
+
+// comparison settings. Each test signal is the burst signal of one player at
+// the 10 kHz decimated rate
+#define COMPARISON_SAMPLE_COUNT 20000
+#define COMPARISON_BURST_START 4000
+#define COMPARISON_BURST_END 8000
+#define COMPARISON_TIMER INTERVAL_TIMER_TIMER_0
+#define NOT_DETECTED -1
+
+// 2cos(w) for each player frequency
+static double coefficients[FILTER_FREQUENCY_COUNT];
+
+// the two previous Goertzel states of every block and how many samples each
+// block has taken
+static double state1[BLOCK_COUNT][FILTER_FREQUENCY_COUNT];
+static double state2[BLOCK_COUNT][FILTER_FREQUENCY_COUNT];
+static uint16_t blockSampleCount[BLOCK_COUNT];
+
+static double currentPower[FILTER_FREQUENCY_COUNT];
+
+// the test signal of the comparison
+static double comparisonSignal[COMPARISON_SAMPLE_COUNT];
+
+// fills comparisonSignal with the test signal for one player
+static void fillComparisonSignal(uint16_t player);
+
+// Clears every block.
+void goertzel_init() {
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    double cyclesPerSample = testSignal_getCyclesPerSample(i);
+    coefficients[i] = 2.0 * cos(TEST_SIGNAL_TWO_PI * cyclesPerSample);
+    currentPower[i] = INITIAL_VALUE;
+  }
+  // each block starts a quarter of a block after the one before it, so the
+  // first results of the later blocks cover a partial block
+  for (uint16_t b = FOR_LOOP_START_VALUE; b < BLOCK_COUNT; b++) {
+    blockSampleCount[b] = b * BLOCK_STAGGER;
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      state1[b][i] = INITIAL_VALUE;
+      state2[b][i] = INITIAL_VALUE;
+    }
+  }
+}
+
+// Adds one decimated sample to every block and updates the powers of any
+// block that finished.
+void goertzel_addSample(double x) {
+  for (uint16_t b = FOR_LOOP_START_VALUE; b < BLOCK_COUNT; b++) {
+    double *s1 = state1[b];
+    double *s2 = state2[b];
+    // the frequencies are independent, so they vectorize
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      double s0 = x + coefficients[i] * s1[i] - s2[i];
+      s2[i] = s1[i];
+      s1[i] = s0;
+    }
+    blockSampleCount[b]++;
+
+    // case this block just took its last sample, so its energies become the
+    // current powers and it starts over
+    if (blockSampleCount[b] >= BLOCK_SIZE) {
+      for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+           i++) {
+        double energy =
+            s1[i] * s1[i] + s2[i] * s2[i] - coefficients[i] * s1[i] * s2[i];
+        currentPower[i] = POWER_SCALE * energy;
+        s1[i] = INITIAL_VALUE;
+        s2[i] = INITIAL_VALUE;
+      }
+      blockSampleCount[b] = FOR_LOOP_START_VALUE;
+    }
+  }
+}
+
+// Returns the power at the given player frequency from the newest finished
+// block.
+double goertzel_getPower(uint16_t filterNumber) {
+  return currentPower[filterNumber];
+}
+
+// Compares the IIR filters plus filter_computePower with Goertzel.
+void goertzel_runComparison(double fudgeFactor) {
+  uint32_t agreements = FOR_LOOP_START_VALUE;
+  uint32_t decisionCount = FOR_LOOP_START_VALUE;
+  filter_iirEngine_t selectedIirEngine = filter_getIirEngine();
+  filter_powerEngine_t selectedPowerEngine = filter_getPowerEngine();
+
+  // times both on the first test signal
+  filter_setIirEngine(FILTER_IIR_DIRECT_FORM);
+  filter_setPowerEngine(FILTER_POWER_IIR);
+  filter_reset();
+  goertzel_init();
+  fillComparisonSignal(FOR_LOOP_START_VALUE);
+  intervalTimer_init(COMPARISON_TIMER);
+  intervalTimer_reset(COMPARISON_TIMER);
+  intervalTimer_start(COMPARISON_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < COMPARISON_SAMPLE_COUNT; n++) {
+    filter_addNewFirOutput(comparisonSignal[n]);
+    filter_iirFilterBank();
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      filter_computePower(i, false, false);
+    }
+  }
+  intervalTimer_stop(COMPARISON_TIMER);
+  double iirSeconds = intervalTimer_getTotalDurationInSeconds(COMPARISON_TIMER) /
+                      COMPARISON_SAMPLE_COUNT;
+  intervalTimer_reset(COMPARISON_TIMER);
+  intervalTimer_start(COMPARISON_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < COMPARISON_SAMPLE_COUNT; n++) {
+    goertzel_addSample(comparisonSignal[n]);
+  }
+  intervalTimer_stop(COMPARISON_TIMER);
+  double goertzelSeconds =
+      intervalTimer_getTotalDurationInSeconds(COMPARISON_TIMER) /
+      COMPARISON_SAMPLE_COUNT;
+  printf("IIR filters and power: %e seconds (%.0f cycles) per decimated "
+         "sample\n",
+         iirSeconds, iirSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  printf("Goertzel:              %e seconds (%.0f cycles) per decimated "
+         "sample\n",
+         goertzelSeconds, goertzelSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+
+  // runs every test signal through both and compares the decisions after
+  // every sample
+  for (uint16_t player = FOR_LOOP_START_VALUE; player < FILTER_FREQUENCY_COUNT;
+       player++) {
+    int32_t iirFirstHit = NOT_DETECTED;
+    int32_t goertzelFirstHit = NOT_DETECTED;
+    filter_reset();
+    goertzel_init();
+    fillComparisonSignal(player);
+
+    for (uint32_t n = FOR_LOOP_START_VALUE; n < COMPARISON_SAMPLE_COUNT; n++) {
+      double iirPowers[FILTER_FREQUENCY_COUNT];
+      double goertzelPowers[FILTER_FREQUENCY_COUNT];
+      filter_addNewFirOutput(comparisonSignal[n]);
+      filter_iirFilterBank();
+      goertzel_addSample(comparisonSignal[n]);
+      for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+           i++) {
+        iirPowers[i] = filter_computePower(i, false, false);
+        goertzelPowers[i] = goertzel_getPower(i);
+      }
+
+      uint16_t iirHit = testSignal_findHit(iirPowers, fudgeFactor);
+      uint16_t goertzelHit = testSignal_findHit(goertzelPowers, fudgeFactor);
+      // case both made the same decision
+      if (iirHit == goertzelHit) {
+        agreements++;
+      }
+      decisionCount++;
+      // case this is the first time either one sees the shooting player
+      if ((iirHit == player) && (iirFirstHit == NOT_DETECTED)) {
+        iirFirstHit = n;
+      }
+      if ((goertzelHit == player) && (goertzelFirstHit == NOT_DETECTED)) {
+        goertzelFirstHit = n;
+      }
+    }
+    printf("player %d: burst starts at sample %d, first hit IIR %ld, "
+           "Goertzel %ld\n",
+           player, COMPARISON_BURST_START, (long)iirFirstHit,
+           (long)goertzelFirstHit);
+  }
+  printf("decisions that agree: %u of %u\n", (unsigned)agreements,
+         (unsigned)decisionCount);
+  // puts back the caller's engines, which filter_reset starts again
+  filter_setIirEngine(selectedIirEngine);
+  filter_setPowerEngine(selectedPowerEngine);
+  filter_reset();
+}
+
+// fills comparisonSignal with the test signal for one player
+static void fillComparisonSignal(uint16_t player) {
+  testSignal_t signal;
+  testSignal_init(&signal, player, FILTER_FIR_DECIMATION_FACTOR);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < COMPARISON_SAMPLE_COUNT; n++) {
+    bool burstOn =
+        (n >= COMPARISON_BURST_START) && (n < COMPARISON_BURST_END);
+    comparisonSignal[n] = testSignal_getSample(&signal, n, burstOn);
+  }
+}
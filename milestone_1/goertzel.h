@@ -0,0 +1,35 @@
+#ifndef GOERTZEL_H_
+#define GOERTZEL_H_
+
+#include <stdint.h>
+
+// Measures the energy of the decimated FIR output at the 10 player
+// frequencies with the Goertzel algorithm, in place of the IIR filters and
+// filter_computePower. Each frequency costs one multiply and two adds per
+// sample instead of a 10th order filter and a squared output.
+//
+// Goertzel gives the energy of a whole block, so 4 staggered blocks of 2000
+// samples run side by side and the power is taken from whichever block
+// finished last. The power is therefore at most 500 samples old. It is scaled
+// so that a tone at a player frequency reads the same as the 2000-sample
+// power of an IIR filter with unit gain at that frequency.
+
+// Clears every block.
+void goertzel_init();
+
+// Adds one decimated sample to every block and updates the powers of any
+// block that finished.
+void goertzel_addSample(double x);
+
+// Returns the power at the given player frequency from the newest finished
+// block.
+double goertzel_getPower(uint16_t filterNumber);
+
+// Runs one test signal per player through the IIR filters with
+// filter_computePower and through Goertzel. Prints the time and cycles per
+// decimated sample of each, and how often their hit decisions (largest power
+// above fudgeFactor times the median, and which player that is) agree.
+// Resets the filters afterwards, with the caller's IIR and power engines.
+void goertzel_runComparison(double fudgeFactor);
+
+#endif /* GOERTZEL_H_ */
@@ -0,0 +1,121 @@
+#include "iirBank.h"
+#include "coef.h"
+#include "simdKernels.h"
+
+#include <stdbool.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+#define INDEX_OFFSET 1
+#define HISTORY_INITIAL_INDEX 0
+
+// the channels are padded to a whole number of vectors. The padding lanes
+// have zero coefficients, so they always output zero
+#define IIR_BANK_LANES SIMD_KERNELS_PADDED_COUNT(FILTER_FREQUENCY_COUNT)
+
+// the a table in coef.h has a spare zero at the end; like filter_iirFilter
+// only the first Z_TAP_COUNT entries are used
+#define B_TAP_COUNT IIR_B_COEFFICIENT_COUNT
+#define Z_TAP_COUNT (IIR_A_COEFFICIENT_COUNT - 1)
+
+// both histories are written twice, one history length apart, so the newest
+// values are always one contiguous span starting at the history index. Rows
+// in the span go from oldest to newest
+#define Y_HISTORY_ROWS (2 * B_TAP_COUNT)
+#define Z_HISTORY_ROWS (2 * Z_TAP_COUNT)
+
+// bCoefficients[j][channel] multiplies span row j of the input history and
+// aCoefficients[j][channel] multiplies span row j of the feedback history,
+// so both tables are stored oldest-tap first
+static double bCoefficients[B_TAP_COUNT][IIR_BANK_LANES]
+    __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double aCoefficients[Z_TAP_COUNT][IIR_BANK_LANES]
+    __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// the input is the same for every channel, so its history is one value per
+// row; the feedback history has one lane per channel
+static double yHistory[Y_HISTORY_ROWS];
+static double zHistory[Z_HISTORY_ROWS][IIR_BANK_LANES]
+    __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static uint16_t yHistoryIndex;
+static uint16_t zHistoryIndex;
+
+// Clears the input and feedback history.
+void iirBank_init() {
+  yHistoryIndex = HISTORY_INITIAL_INDEX;
+  zHistoryIndex = HISTORY_INITIAL_INDEX;
+  for (uint16_t ch = FOR_LOOP_START_VALUE; ch < IIR_BANK_LANES; ch++) {
+    // case this lane is a real channel, so its coefficients are copied in
+    // reverse tap order
+    bool realChannel = ch < FILTER_FREQUENCY_COUNT;
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < B_TAP_COUNT; j++) {
+      bCoefficients[j][ch] =
+          realChannel
+              ? iirBCoefficientConstants[ch][B_TAP_COUNT - INDEX_OFFSET - j]
+              : INITIAL_VALUE;
+    }
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < Z_TAP_COUNT; j++) {
+      aCoefficients[j][ch] =
+          realChannel
+              ? iirACoefficientConstants[ch][Z_TAP_COUNT - INDEX_OFFSET - j]
+              : INITIAL_VALUE;
+    }
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < Z_HISTORY_ROWS; j++) {
+      zHistory[j][ch] = INITIAL_VALUE;
+    }
+  }
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < Y_HISTORY_ROWS; j++) {
+    yHistory[j] = INITIAL_VALUE;
+  }
+}
+
+// Runs one decimated sample through all 10 filters.
+void iirBank_filter(double x, double outputs[]) {
+  double sums[IIR_BANK_LANES] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+  double feedback[IIR_BANK_LANES]
+      __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+  // adds the new input to the input history
+  yHistory[yHistoryIndex] = x;
+  yHistory[yHistoryIndex + B_TAP_COUNT] = x;
+  yHistoryIndex++;
+  // case the index reached the mirror, so it wraps back to the start
+  if (yHistoryIndex >= B_TAP_COUNT) {
+    yHistoryIndex = HISTORY_INITIAL_INDEX;
+  }
+
+  for (uint16_t ch = FOR_LOOP_START_VALUE; ch < IIR_BANK_LANES; ch++) {
+    sums[ch] = INITIAL_VALUE;
+    feedback[ch] = INITIAL_VALUE;
+  }
+
+  // b*y: every input value is shared by all channels, so it is broadcast
+  const double *ySpan = &yHistory[yHistoryIndex];
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < B_TAP_COUNT; j++) {
+    simdKernels_scaleAccumulate(sums, bCoefficients[j], ySpan[j],
+                                IIR_BANK_LANES);
+  }
+  // a*z: one row of feedback history per tap, one lane per channel
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < Z_TAP_COUNT; j++) {
+    simdKernels_multiplyAccumulate(feedback, aCoefficients[j],
+                                   zHistory[zHistoryIndex + j],
+                                   IIR_BANK_LANES);
+  }
+
+  // the new outputs become the newest feedback row
+  double *newestRow = zHistory[zHistoryIndex];
+  double *mirrorRow = zHistory[zHistoryIndex + Z_TAP_COUNT];
+  for (uint16_t ch = FOR_LOOP_START_VALUE; ch < IIR_BANK_LANES; ch++) {
+    double output = sums[ch] - feedback[ch];
+    newestRow[ch] = output;
+    mirrorRow[ch] = output;
+    // case this is a real channel and not padding
+    if (ch < FILTER_FREQUENCY_COUNT) {
+      outputs[ch] = output;
+    }
+  }
+  zHistoryIndex++;
+  if (zHistoryIndex >= Z_TAP_COUNT) {
+    zHistoryIndex = HISTORY_INITIAL_INDEX;
+  }
+}
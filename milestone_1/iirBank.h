@@ -0,0 +1,18 @@
+#ifndef IIRBANK_H_
+#define IIRBANK_H_
+
+#include <stdint.h>
+
+// Runs all 10 direct form IIR filters from coef.h in one call. Coefficients
+// and feedback state are stored channel-interleaved (a[k][channel],
+// z[k][channel]), so every multiply-add updates 2 (SSE2) or 4 (AVX2) channels
+// at once. The math is the same as filter_iirFilter, in double.
+
+// Clears the input and feedback history.
+void iirBank_init();
+
+// Runs one decimated sample through all 10 filters. outputs must hold 10
+// values.
+void iirBank_filter(double x, double outputs[]);
+
+#endif /* IIRBANK_H_ */
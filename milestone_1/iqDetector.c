@@ -0,0 +1,111 @@
+#include "iqDetector.h"
+#include "filter.h"
+#include "testSignal.h"
+
+#include <math.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+
+#define WINDOW_SIZE FILTER_INPUT_PULSE_WIDTH
+
+// one table entry per tick of the 100 kHz transmitter clock, so a decimated
+// sample advances the oscillator by the decimation factor
+#define MAX_TICKS_PER_PERIOD 128
+#define PHASE_STEP FILTER_FIR_DECIMATION_FACTOR
+
+// I^2 + Q^2 of a tone of amplitude A over the window is (A * 2000 / 2)^2, and
+// the 2000-sample power of the same tone is 2000 * A^2 / 2
+#define POWER_SCALE (2.0 / WINDOW_SIZE)
+
+// one period of the oscillator of every player, and its length in ticks
+static double cosineTable[FILTER_FREQUENCY_COUNT][MAX_TICKS_PER_PERIOD];
+static double sineTable[FILTER_FREQUENCY_COUNT][MAX_TICKS_PER_PERIOD];
+static uint16_t ticksPerPeriod[FILTER_FREQUENCY_COUNT];
+
+// table position of the newest sample, and how far behind it the position
+// of the sample leaving the window is
+static uint16_t phase[FILTER_FREQUENCY_COUNT];
+static uint16_t windowPhaseOffset[FILTER_FREQUENCY_COUNT];
+
+// the last 2000 samples, the oldest at historyIndex
+static double history[WINDOW_SIZE];
+static uint16_t historyIndex;
+
+// I and Q summed over the window. They are updated by adding the newest
+// mixed sample and subtracting the one leaving, and replaced by the window
+// sums (the same sums taken from scratch) every time historyIndex wraps, so
+// rounding never builds up
+static double inPhaseSum[FILTER_FREQUENCY_COUNT];
+static double quadratureSum[FILTER_FREQUENCY_COUNT];
+static double inPhaseWindowSum[FILTER_FREQUENCY_COUNT];
+static double quadratureWindowSum[FILTER_FREQUENCY_COUNT];
+
+// Builds the oscillator tables and clears the sums and the input history.
+void iqDetector_init() {
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    ticksPerPeriod[i] = filter_frequencyTickTable[i];
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < ticksPerPeriod[i]; k++) {
+      cosineTable[i][k] = cos(TEST_SIGNAL_TWO_PI * k / ticksPerPeriod[i]);
+      sineTable[i][k] = -sin(TEST_SIGNAL_TWO_PI * k / ticksPerPeriod[i]);
+    }
+    phase[i] = FOR_LOOP_START_VALUE;
+    windowPhaseOffset[i] = (WINDOW_SIZE * PHASE_STEP) % ticksPerPeriod[i];
+    inPhaseSum[i] = INITIAL_VALUE;
+    quadratureSum[i] = INITIAL_VALUE;
+    inPhaseWindowSum[i] = INITIAL_VALUE;
+    quadratureWindowSum[i] = INITIAL_VALUE;
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < WINDOW_SIZE; k++) {
+    history[k] = INITIAL_VALUE;
+  }
+  historyIndex = FOR_LOOP_START_VALUE;
+}
+
+// Mixes one decimated sample with every oscillator and slides the sums.
+void iqDetector_addSample(double x) {
+  double leaving = history[historyIndex];
+  history[historyIndex] = x;
+
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    uint16_t ticks = ticksPerPeriod[i];
+    // the leaving sample was mixed 2000 samples ago, that many steps back
+    uint16_t leavingPhase = (phase[i] + ticks - windowPhaseOffset[i]) % ticks;
+    double inPhase = x * cosineTable[i][phase[i]];
+    double quadrature = x * sineTable[i][phase[i]];
+
+    inPhaseSum[i] = inPhaseSum[i] + inPhase -
+                    leaving * cosineTable[i][leavingPhase];
+    quadratureSum[i] = quadratureSum[i] + quadrature -
+                       leaving * sineTable[i][leavingPhase];
+    inPhaseWindowSum[i] = inPhaseWindowSum[i] + inPhase;
+    quadratureWindowSum[i] = quadratureWindowSum[i] + quadrature;
+
+    phase[i] = phase[i] + PHASE_STEP;
+    // case the oscillator passed the end of its period
+    if (phase[i] >= ticks) {
+      phase[i] = phase[i] - ticks;
+    }
+  }
+
+  historyIndex++;
+  // case the whole window was replaced, so the sums taken from scratch
+  // replace the running ones
+  if (historyIndex >= WINDOW_SIZE) {
+    historyIndex = FOR_LOOP_START_VALUE;
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      inPhaseSum[i] = inPhaseWindowSum[i];
+      quadratureSum[i] = quadratureWindowSum[i];
+      inPhaseWindowSum[i] = INITIAL_VALUE;
+      quadratureWindowSum[i] = INITIAL_VALUE;
+    }
+  }
+}
+
+// Returns I^2 + Q^2 over the last 2000 samples at the given player
+// frequency.
+double iqDetector_getPower(uint16_t filterNumber) {
+  return POWER_SCALE * (inPhaseSum[filterNumber] * inPhaseSum[filterNumber] +
+                        quadratureSum[filterNumber] *
+                            quadratureSum[filterNumber]);
+}
@@ -0,0 +1,28 @@
+#ifndef IQDETECTOR_H_
+#define IQDETECTOR_H_
+
+#include <stdint.h>
+
+// Measures the power at each player frequency by mixing the decimated FIR
+// output down to DC with a table-driven oscillator and summing I and Q over
+// the last 2000 samples (a first order CIC: an integrator with a 2000-sample
+// comb), in place of the IIR filters and filter_computePower. Each player
+// costs four multiplies and four adds per sample.
+//
+// The oscillator tables are built from filter_frequencyTickTable: a player
+// whose transmitter toggles every ticks/2 ticks of the 100 kHz clock gets a
+// one-period table of ticks entries, stepped by 10 entries per decimated
+// sample, so it always runs at exactly the transmitter frequency. The power
+// I^2 + Q^2 is scaled like goertzel_getPower.
+
+// Builds the oscillator tables and clears the sums and the input history.
+void iqDetector_init();
+
+// Mixes one decimated sample with every oscillator and slides the sums.
+void iqDetector_addSample(double x);
+
+// Returns I^2 + Q^2 over the last 2000 samples at the given player
+// frequency.
+double iqDetector_getPower(uint16_t filterNumber);
+
+#endif /* IQDETECTOR_H_ */
@@ -0,0 +1,382 @@
+#include "multistageDecimator.h"
+#include "coef.h"
+#include "filter.h"
+#include "filterModes.h"
+#include "intervalTimer.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_SUM_VALUE 0.0
+#define INDEX_OFFSET 1
+
+// largest decimation factor and taps per phase any stage uses
+#define MAX_STAGE_DECIMATION 10
+#define MAX_TAPS_PER_PHASE 16
+
+#define SINGLE_FIR_DECIMATION 10
+#define HALF_BAND_DECIMATION 2
+#define HALF_BAND_SECOND_STAGE_DECIMATION 5
+#define CIC_COMPENSATOR_DECIMATION 1
+
+#define STAGE_OUTPUT_PHASE 0
+#define STAGE_NEXT_OUTPUT_INDEX 0
+
+// 4 integrators and 4 combs decimating by 10. The CIC gain is 10^4, so a
+// 12 bit code grows to at most 26 bits and the integrators can wrap freely
+// in 32 bit unsigned arithmetic without changing the comb output
+#define CIC_ORDER 4
+#define CIC_DECIMATION 10
+#define CIC_GAIN 10000.0
+#define CIC_INITIAL_VALUE 0
+
+// maps raw 12 bit ADC codes onto -1 to 1, same as the detector's scaling
+#define RAW_ADC_SCALING 2047.5
+#define ADC_OFFSET 1.0
+
+// report settings: tones are run through each decimator for
+// REPORT_SAMPLE_COUNT samples and the first REPORT_SETTLE_OUTPUTS outputs
+// are skipped so the filters have settled before the amplitude is measured
+#define REPORT_SAMPLE_COUNT 20000
+#define REPORT_SETTLE_OUTPUTS 50
+#define REPORT_BLOCK_SIZE 100
+#define REPORT_MAX_OUTPUTS (REPORT_SAMPLE_COUNT / SINGLE_FIR_DECIMATION + 1)
+#define REPORT_TONE_AMPLITUDE 2000.0
+#define REPORT_ADC_MIDPOINT 2047.5
+#define REPORT_ROUNDING_OFFSET 0.5
+#define REPORT_SAMPLE_RATE_HZ 100000.0
+#define REPORT_DECIMATED_RATE_HZ 10000.0
+#define REPORT_TIMING_SAMPLES 100000
+#define REPORT_TIMER INTERVAL_TIMER_TIMER_0
+#define REPORT_DECIMATOR_COUNT 3
+#define DECIBELS_PER_AMPLITUDE_DECADE 20.0
+#define SECONDS_TO_NANOSECONDS 1e9
+
+// one polyphase FIR stage. Each input sample is multiplied into the partial
+// sums of every output it contributes to, and only the non-zero taps of each
+// phase are stored, so the zero taps of the half-band stage cost nothing.
+// phase is the number of samples left until the next output
+typedef struct {
+  uint16_t decimation;
+  uint16_t accumulatorCount;
+  uint16_t phase;
+  uint16_t phaseTapCount[MAX_STAGE_DECIMATION];
+  double phaseCoefficients[MAX_STAGE_DECIMATION][MAX_TAPS_PER_PHASE];
+  uint16_t phaseAccumulatorIndex[MAX_STAGE_DECIMATION][MAX_TAPS_PER_PHASE];
+  double accumulators[MAX_TAPS_PER_PHASE];
+} decimatorStage_t;
+
+// integrator and comb state of the CIC
+typedef struct {
+  uint32_t integrators[CIC_ORDER];
+  uint32_t combDelays[CIC_ORDER];
+  uint16_t phase;
+} cicState_t;
+
+// everything one decimator needs. The CIC type uses cic then firstStage as
+// the compensator; the FIR types use firstStage and, for the half-band type,
+// secondStage
+typedef struct {
+  multistageDecimator_type_t type;
+  cicState_t cic;
+  decimatorStage_t firstStage;
+  decimatorStage_t secondStage;
+} decimator_t;
+
+static decimator_t activeDecimator;
+
+static const char *decimatorNames[REPORT_DECIMATOR_COUNT] = {
+    "single 81-tap FIR", "CIC + 15-tap compensator",
+    "half-band + 31-tap FIR"};
+
+// splits a coefficient table into phases and clears the partial sums
+static void initStage(decimatorStage_t *stage, const double coefficients[],
+                      uint16_t tapCount, uint16_t decimation);
+
+// adds one sample to a stage. Returns true and writes output when the sample
+// completes a decimated output
+static bool stagePush(decimatorStage_t *stage, double x, double *output);
+
+// clears the CIC integrators and combs
+static void initCic(cicState_t *cic);
+
+// adds one raw code to the CIC. Returns true and writes the scaled output
+// when the sample completes a decimated output
+static bool cicPush(cicState_t *cic, uint32_t adcValue, double *output);
+
+// sets up a decimator of the given type
+static void initDecimator(decimator_t *decimator,
+                          multistageDecimator_type_t type);
+
+// runs a block of raw codes through a decimator
+static uint32_t decimateBlock(decimator_t *decimator,
+                              const uint32_t adcValues[], uint32_t count,
+                              double decimatedOutputs[]);
+
+// fills a block with raw codes of a tone, starting at sample number start
+static void fillToneBlock(uint32_t block[], uint32_t count, uint32_t start,
+                          double frequency);
+
+// runs a tone through a fresh decimator and returns its amplitude gain
+static double measureToneGain(multistageDecimator_type_t type,
+                              double frequency);
+
+// returns the seconds a decimator takes per ADC sample
+static double measureSecondsPerSample(multistageDecimator_type_t type);
+
+// Selects the decimator and clears its state.
+void multistageDecimator_init(multistageDecimator_type_t type) {
+  initDecimator(&activeDecimator, type);
+}
+
+// Scales and decimates a block of raw ADC values with the selected decimator.
+uint32_t multistageDecimator_decimateAdcBlock(const uint32_t adcValues[],
+                                              uint32_t count,
+                                              double decimatedOutputs[]) {
+  return decimateBlock(&activeDecimator, adcValues, count, decimatedOutputs);
+}
+
+// Prints the gain of each decimator at the 10 player frequencies, its
+// rejection of the tones that alias onto them, and its time per ADC sample.
+void multistageDecimator_runReport() {
+  for (uint16_t type = FOR_LOOP_START_VALUE; type < REPORT_DECIMATOR_COUNT;
+       type++) {
+    printf("%s\n", decimatorNames[type]);
+    // the tones at 10 kHz +/- the player frequency land on the player
+    // frequency after decimation, so their gain is the alias rejection
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      double frequency = REPORT_SAMPLE_RATE_HZ / filter_frequencyTickTable[i];
+      double passbandGain = measureToneGain(type, frequency);
+      double lowerAliasGain =
+          measureToneGain(type, REPORT_DECIMATED_RATE_HZ - frequency);
+      double upperAliasGain =
+          measureToneGain(type, REPORT_DECIMATED_RATE_HZ + frequency);
+      double worstAliasGain = fmax(lowerAliasGain, upperAliasGain);
+      printf("  player %d (%5.0f Hz): passband %6.2f dB, alias rejection "
+             "%6.2f dB\n",
+             i, frequency,
+             DECIBELS_PER_AMPLITUDE_DECADE * log10(passbandGain),
+             DECIBELS_PER_AMPLITUDE_DECADE *
+                 log10(worstAliasGain / passbandGain));
+    }
+    double secondsPerSample = measureSecondsPerSample(type);
+    printf("  %.1f ns per ADC sample (%.0f cycles at %.0f MHz)\n",
+           secondsPerSample * SECONDS_TO_NANOSECONDS,
+           secondsPerSample * FILTER_BENCHMARK_CPU_CLOCK_HZ,
+           FILTER_BENCHMARK_CPU_CLOCK_HZ / 1e6);
+  }
+}
+
+// splits a coefficient table into phases and clears the partial sums
+static void initStage(decimatorStage_t *stage, const double coefficients[],
+                      uint16_t tapCount, uint16_t decimation) {
+  stage->decimation = decimation;
+  stage->accumulatorCount = (tapCount + decimation - INDEX_OFFSET) / decimation;
+  stage->phase = decimation - INDEX_OFFSET;
+  // phase p holds taps p, p + decimation, p + 2*decimation, ... and tap
+  // p + j*decimation feeds the output j decimated samples ahead
+  for (uint16_t p = FOR_LOOP_START_VALUE; p < decimation; p++) {
+    stage->phaseTapCount[p] = FOR_LOOP_START_VALUE;
+    for (uint16_t j = FOR_LOOP_START_VALUE; j < stage->accumulatorCount; j++) {
+      uint16_t tap = p + j * decimation;
+      // case the tap exists and is not zero, so it is kept
+      if ((tap < tapCount) && (coefficients[tap] != INITIAL_SUM_VALUE)) {
+        uint16_t index = stage->phaseTapCount[p];
+        stage->phaseCoefficients[p][index] = coefficients[tap];
+        stage->phaseAccumulatorIndex[p][index] = j;
+        stage->phaseTapCount[p]++;
+      }
+    }
+  }
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < MAX_TAPS_PER_PHASE; j++) {
+    stage->accumulators[j] = INITIAL_SUM_VALUE;
+  }
+}
+
+// adds one sample to a stage. Returns true and writes output when the sample
+// completes a decimated output
+static bool stagePush(decimatorStage_t *stage, double x, double *output) {
+  uint16_t phase = stage->phase;
+  // adds this sample into every output it contributes to
+  for (uint16_t j = FOR_LOOP_START_VALUE; j < stage->phaseTapCount[phase];
+       j++) {
+    uint16_t index = stage->phaseAccumulatorIndex[phase][j];
+    stage->accumulators[index] =
+        stage->accumulators[index] + stage->phaseCoefficients[phase][j] * x;
+  }
+
+  // case this sample does not complete an output
+  if (phase != STAGE_OUTPUT_PHASE) {
+    stage->phase--;
+    return false;
+  }
+
+  // emits the output and moves the partial sums down by one output
+  *output = stage->accumulators[STAGE_NEXT_OUTPUT_INDEX];
+  for (uint16_t j = FOR_LOOP_START_VALUE;
+       j < stage->accumulatorCount - INDEX_OFFSET; j++) {
+    stage->accumulators[j] = stage->accumulators[j + INDEX_OFFSET];
+  }
+  stage->accumulators[stage->accumulatorCount - INDEX_OFFSET] =
+      INITIAL_SUM_VALUE;
+  stage->phase = stage->decimation - INDEX_OFFSET;
+  return true;
+}
+
+// clears the CIC integrators and combs
+static void initCic(cicState_t *cic) {
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < CIC_ORDER; k++) {
+    cic->integrators[k] = CIC_INITIAL_VALUE;
+    cic->combDelays[k] = CIC_INITIAL_VALUE;
+  }
+  cic->phase = CIC_DECIMATION - INDEX_OFFSET;
+}
+
+// adds one raw code to the CIC. Returns true and writes the scaled output
+// when the sample completes a decimated output
+static bool cicPush(cicState_t *cic, uint32_t adcValue, double *output) {
+  // runs the integrators at the full rate
+  cic->integrators[FOR_LOOP_START_VALUE] += adcValue;
+  for (uint16_t k = INDEX_OFFSET; k < CIC_ORDER; k++) {
+    cic->integrators[k] += cic->integrators[k - INDEX_OFFSET];
+  }
+
+  // case this sample does not complete an output
+  if (cic->phase != STAGE_OUTPUT_PHASE) {
+    cic->phase--;
+    return false;
+  }
+
+  // runs the combs at the decimated rate
+  uint32_t value = cic->integrators[CIC_ORDER - INDEX_OFFSET];
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < CIC_ORDER; k++) {
+    uint32_t difference = value - cic->combDelays[k];
+    cic->combDelays[k] = value;
+    value = difference;
+  }
+  cic->phase = CIC_DECIMATION - INDEX_OFFSET;
+  *output = value / (CIC_GAIN * RAW_ADC_SCALING) - ADC_OFFSET;
+  return true;
+}
+
+// sets up a decimator of the given type
+static void initDecimator(decimator_t *decimator,
+                          multistageDecimator_type_t type) {
+  decimator->type = type;
+  switch (type) {
+  case MULTISTAGE_DECIMATOR_CIC:
+    initCic(&decimator->cic);
+    initStage(&decimator->firstStage, cicCompensatorCoefficients,
+              CIC_COMPENSATOR_TAP_COUNT, CIC_COMPENSATOR_DECIMATION);
+    break;
+  case MULTISTAGE_DECIMATOR_HALF_BAND:
+    initStage(&decimator->firstStage, halfBandCoefficients,
+              HALF_BAND_TAP_COUNT, HALF_BAND_DECIMATION);
+    initStage(&decimator->secondStage, halfBandSecondStageCoefficients,
+              HALF_BAND_SECOND_STAGE_TAP_COUNT,
+              HALF_BAND_SECOND_STAGE_DECIMATION);
+    break;
+  // the reference is the 81-tap FIR as a single stage
+  default:
+    decimator->type = MULTISTAGE_DECIMATOR_SINGLE_FIR;
+    initStage(&decimator->firstStage, firCoefficients, FIR_FILTER_TAP_COUNT,
+              SINGLE_FIR_DECIMATION);
+    break;
+  }
+}
+
+// runs a block of raw codes through a decimator
+static uint32_t decimateBlock(decimator_t *decimator,
+                              const uint32_t adcValues[], uint32_t count,
+                              double decimatedOutputs[]) {
+  uint32_t outputCount = FOR_LOOP_START_VALUE;
+  double stageOutput;
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    // case the CIC runs on the raw codes and only its outputs are scaled
+    if (decimator->type == MULTISTAGE_DECIMATOR_CIC) {
+      if (cicPush(&decimator->cic, adcValues[i], &stageOutput) &&
+          stagePush(&decimator->firstStage, stageOutput,
+                    &decimatedOutputs[outputCount])) {
+        outputCount++;
+      }
+      continue;
+    }
+
+    double x = adcValues[i] / RAW_ADC_SCALING - ADC_OFFSET;
+    // case the single FIR does all of the decimation on its own
+    if (decimator->type == MULTISTAGE_DECIMATOR_SINGLE_FIR) {
+      if (stagePush(&decimator->firstStage, x,
+                    &decimatedOutputs[outputCount])) {
+        outputCount++;
+      }
+    }
+    // case the half-band output feeds the second stage
+    else if (stagePush(&decimator->firstStage, x, &stageOutput) &&
+             stagePush(&decimator->secondStage, stageOutput,
+                       &decimatedOutputs[outputCount])) {
+      outputCount++;
+    }
+  }
+  return outputCount;
+}
+
+// fills a block with raw codes of a tone, starting at sample number start
+static void fillToneBlock(uint32_t block[], uint32_t count, uint32_t start,
+                          double frequency) {
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < count; i++) {
+    double phase = 2 * M_PI * frequency * (start + i) / REPORT_SAMPLE_RATE_HZ;
+    block[i] = (uint32_t)(REPORT_ADC_MIDPOINT +
+                          REPORT_TONE_AMPLITUDE * sin(phase) +
+                          REPORT_ROUNDING_OFFSET);
+  }
+}
+
+// runs a tone through a fresh decimator and returns its amplitude gain
+static double measureToneGain(multistageDecimator_type_t type,
+                              double frequency) {
+  static decimator_t decimator;
+  static double outputs[REPORT_MAX_OUTPUTS];
+  uint32_t block[REPORT_BLOCK_SIZE];
+  uint32_t outputCount = FOR_LOOP_START_VALUE;
+
+  initDecimator(&decimator, type);
+  for (uint32_t start = FOR_LOOP_START_VALUE; start < REPORT_SAMPLE_COUNT;
+       start += REPORT_BLOCK_SIZE) {
+    fillToneBlock(block, REPORT_BLOCK_SIZE, start, frequency);
+    outputCount += decimateBlock(&decimator, block, REPORT_BLOCK_SIZE,
+                                 &outputs[outputCount]);
+  }
+
+  // the gain is the RMS of the settled output (without its DC) compared to
+  // the RMS of the scaled input tone
+  double mean = INITIAL_SUM_VALUE;
+  double sumOfSquares = INITIAL_SUM_VALUE;
+  uint32_t settledCount = outputCount - REPORT_SETTLE_OUTPUTS;
+  for (uint32_t i = REPORT_SETTLE_OUTPUTS; i < outputCount; i++) {
+    mean = mean + outputs[i];
+  }
+  mean = mean / settledCount;
+  for (uint32_t i = REPORT_SETTLE_OUTPUTS; i < outputCount; i++) {
+    sumOfSquares = sumOfSquares + (outputs[i] - mean) * (outputs[i] - mean);
+  }
+  double inputRms = (REPORT_TONE_AMPLITUDE / RAW_ADC_SCALING) / M_SQRT2;
+  return sqrt(sumOfSquares / settledCount) / inputRms;
+}
+
+// returns the seconds a decimator takes per ADC sample
+static double measureSecondsPerSample(multistageDecimator_type_t type) {
+  static decimator_t decimator;
+  static uint32_t samples[REPORT_TIMING_SAMPLES];
+  static double outputs[REPORT_TIMING_SAMPLES / SINGLE_FIR_DECIMATION + 1];
+
+  initDecimator(&decimator, type);
+  fillToneBlock(samples, REPORT_TIMING_SAMPLES, FOR_LOOP_START_VALUE,
+                REPORT_SAMPLE_RATE_HZ / filter_frequencyTickTable[0]);
+  intervalTimer_init(REPORT_TIMER);
+  intervalTimer_start(REPORT_TIMER);
+  decimateBlock(&decimator, samples, REPORT_TIMING_SAMPLES, outputs);
+  intervalTimer_stop(REPORT_TIMER);
+  return intervalTimer_getTotalDurationInSeconds(REPORT_TIMER) /
+         REPORT_TIMING_SAMPLES;
+}
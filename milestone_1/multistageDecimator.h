@@ -0,0 +1,35 @@
+#ifndef MULTISTAGEDECIMATOR_H_
+#define MULTISTAGEDECIMATOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cheaper alternatives to the single 81-tap decimating FIR. Both take raw
+// 100 kHz ADC codes and produce the same 10 kHz decimated signal (with the
+// same 0.5 passband gain) that filter_firFilter does. Their FIR tables in
+// coef.h come from generator/decimatorDesign.py.
+typedef enum {
+  // the 81-tap FIR from coef.h run as one stage, used as the reference
+  MULTISTAGE_DECIMATOR_SINGLE_FIR,
+  // 4th order integer CIC decimating by 10, then a 15-tap FIR at 10 kHz
+  // that flattens the CIC droop
+  MULTISTAGE_DECIMATOR_CIC,
+  // 11-tap half-band FIR decimating by 2, then a 31-tap FIR decimating by 5
+  MULTISTAGE_DECIMATOR_HALF_BAND
+} multistageDecimator_type_t;
+
+// Selects the decimator and clears its state.
+void multistageDecimator_init(multistageDecimator_type_t type);
+
+// Scales and decimates a block of raw ADC values with the selected decimator.
+// Writes the decimated outputs to decimatedOutputs and returns how many there
+// were. State carries across calls so blocks can be any length.
+uint32_t multistageDecimator_decimateAdcBlock(const uint32_t adcValues[],
+                                              uint32_t count,
+                                              double decimatedOutputs[]);
+
+// Prints the gain of each decimator at the 10 player frequencies, its
+// rejection of the tones that alias onto them, and its time per ADC sample.
+void multistageDecimator_runReport();
+
+#endif /* MULTISTAGEDECIMATOR_H_ */
@@ -0,0 +1,78 @@
+#include "parallelIir.h"
+#include "coef.h"
+#include "simdKernels.h"
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+
+// positions of the coefficients within one section of iirParallelSections
+#define SECTION_B0 0
+#define SECTION_B1 1
+#define SECTION_A1 2
+#define SECTION_A2 3
+
+// every section of every filter gets its own lane, filter by filter. The
+// lanes are padded to a whole number of vectors; the padding lanes have zero
+// coefficients and are never read back
+#define SECTION_COUNT (FILTER_FREQUENCY_COUNT * IIR_PARALLEL_SECTION_COUNT)
+#define SECTION_LANES SIMD_KERNELS_PADDED_COUNT(SECTION_COUNT)
+
+// coefficients and transposed direct form II state, one lane per section
+static double b0[SECTION_LANES] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double b1[SECTION_LANES] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double a1[SECTION_LANES] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double a2[SECTION_LANES] __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double state1[SECTION_LANES]
+    __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+static double state2[SECTION_LANES]
+    __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+// Clears the state of every section.
+void parallelIir_init() {
+  for (uint16_t lane = FOR_LOOP_START_VALUE; lane < SECTION_LANES; lane++) {
+    // case this lane is padding past the last section
+    if (lane >= SECTION_COUNT) {
+      b0[lane] = INITIAL_VALUE;
+      b1[lane] = INITIAL_VALUE;
+      a1[lane] = INITIAL_VALUE;
+      a2[lane] = INITIAL_VALUE;
+    } else {
+      const double *section =
+          iirParallelSections[lane / IIR_PARALLEL_SECTION_COUNT]
+                             [lane % IIR_PARALLEL_SECTION_COUNT];
+      b0[lane] = section[SECTION_B0];
+      b1[lane] = section[SECTION_B1];
+      a1[lane] = section[SECTION_A1];
+      a2[lane] = section[SECTION_A2];
+    }
+    state1[lane] = INITIAL_VALUE;
+    state2[lane] = INITIAL_VALUE;
+  }
+}
+
+// Runs one decimated sample through all 10 filters.
+void parallelIir_filterBank(double x, double outputs[]) {
+  double sectionOutputs[SECTION_LANES]
+      __attribute__((aligned(SIMD_KERNELS_ALIGNMENT)));
+
+  // every lane only touches its own state, so the compiler can step as many
+  // sections per instruction as the vector width allows
+  for (uint16_t lane = FOR_LOOP_START_VALUE; lane < SECTION_LANES; lane++) {
+    double y = b0[lane] * x + state1[lane];
+    state1[lane] = b1[lane] * x - a1[lane] * y + state2[lane];
+    state2[lane] = -a2[lane] * y;
+    sectionOutputs[lane] = y;
+  }
+
+  // each filter is its direct term plus the sum of its sections
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    double sum = iirParallelDirectTerms[i] * x;
+    const double *filterSections =
+        &sectionOutputs[i * IIR_PARALLEL_SECTION_COUNT];
+    for (uint16_t s = FOR_LOOP_START_VALUE; s < IIR_PARALLEL_SECTION_COUNT;
+         s++) {
+      sum = sum + filterSections[s];
+    }
+    outputs[i] = sum;
+  }
+}
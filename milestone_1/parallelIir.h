@@ -0,0 +1,21 @@
+#ifndef PARALLELIIR_H_
+#define PARALLELIIR_H_
+
+#include <stdint.h>
+
+// Runs the 10 IIR filters from coef.h in parallel form: each filter is a
+// direct term plus 5 second order sections that all see the same input and
+// whose outputs are summed. Unlike the direct form and the biquad cascade,
+// no section waits on another, so all 50 sections are stepped together in
+// vector lanes. The sections are the iirParallelDirectTerms and
+// iirParallelSections tables of coef.h, which generator/parallelSections.py
+// computes from the direct form rows.
+
+// Clears the state of every section.
+void parallelIir_init();
+
+// Runs one decimated sample through all 10 filters. outputs must hold 10
+// values.
+void parallelIir_filterBank(double x, double outputs[]);
+
+#endif /* PARALLELIIR_H_ */
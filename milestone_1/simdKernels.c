@@ -0,0 +1,190 @@
+#include "simdKernels.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_SUM_VALUE 0.0
+
+#define AVX2_DOUBLE_WIDTH 4
+#define SSE2_DOUBLE_WIDTH 2
+
+#define INSTRUCTION_SET_AVX2 "AVX2"
+#define INSTRUCTION_SET_SSE2 "SSE2"
+#define INSTRUCTION_SET_SCALAR "scalar"
+
+// Returns the sum of a[i]*b[i] for i in [0, count). The pointers do not have
+// to be aligned.
+double simdKernels_dotProduct(const double *a, const double *b,
+                              uint32_t count) {
+  double sum = INITIAL_SUM_VALUE;
+  uint32_t i = FOR_LOOP_START_VALUE;
+#if defined(__AVX2__)
+  // two accumulators so consecutive adds do not wait on each other
+  __m256d sum0 = _mm256_setzero_pd();
+  __m256d sum1 = _mm256_setzero_pd();
+  for (; i + 2 * AVX2_DOUBLE_WIDTH <= count; i += 2 * AVX2_DOUBLE_WIDTH) {
+    sum0 = _mm256_add_pd(
+        sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    sum1 = _mm256_add_pd(
+        sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + AVX2_DOUBLE_WIDTH),
+                            _mm256_loadu_pd(b + i + AVX2_DOUBLE_WIDTH)));
+  }
+  for (; i + AVX2_DOUBLE_WIDTH <= count; i += AVX2_DOUBLE_WIDTH) {
+    sum0 = _mm256_add_pd(
+        sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  sum0 = _mm256_add_pd(sum0, sum1);
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum0),
+                            _mm256_extractf128_pd(sum0, 1));
+  sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#elif defined(__SSE2__)
+  __m128d sum0 = _mm_setzero_pd();
+  __m128d sum1 = _mm_setzero_pd();
+  for (; i + 2 * SSE2_DOUBLE_WIDTH <= count; i += 2 * SSE2_DOUBLE_WIDTH) {
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    sum1 = _mm_add_pd(sum1,
+                      _mm_mul_pd(_mm_loadu_pd(a + i + SSE2_DOUBLE_WIDTH),
+                                 _mm_loadu_pd(b + i + SSE2_DOUBLE_WIDTH)));
+  }
+  sum0 = _mm_add_pd(sum0, sum1);
+  sum = _mm_cvtsd_f64(_mm_add_sd(sum0, _mm_unpackhi_pd(sum0, sum0)));
+#endif
+  // scalar loop for the fallback build and for any tail the vector loops left
+  for (; i < count; i++) {
+    sum = sum + a[i] * b[i];
+  }
+  return sum;
+}
+
+// Adds a[i]*b[i] to accumulators[i] for i in [0, count).
+void simdKernels_multiplyAccumulate(double *accumulators, const double *a,
+                                    const double *b, uint32_t count) {
+  uint32_t i = FOR_LOOP_START_VALUE;
+#if defined(__AVX2__)
+  for (; i + AVX2_DOUBLE_WIDTH <= count; i += AVX2_DOUBLE_WIDTH) {
+    __m256d product =
+        _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+    _mm256_storeu_pd(accumulators + i,
+                     _mm256_add_pd(_mm256_loadu_pd(accumulators + i), product));
+  }
+#elif defined(__SSE2__)
+  for (; i + SSE2_DOUBLE_WIDTH <= count; i += SSE2_DOUBLE_WIDTH) {
+    __m128d product = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+    _mm_storeu_pd(accumulators + i,
+                  _mm_add_pd(_mm_loadu_pd(accumulators + i), product));
+  }
+#endif
+  for (; i < count; i++) {
+    accumulators[i] = accumulators[i] + a[i] * b[i];
+  }
+}
+
+// Adds a[i]*scale to accumulators[i] for i in [0, count).
+void simdKernels_scaleAccumulate(double *accumulators, const double *a,
+                                 double scale, uint32_t count) {
+  uint32_t i = FOR_LOOP_START_VALUE;
+#if defined(__AVX2__)
+  __m256d scales = _mm256_set1_pd(scale);
+  for (; i + AVX2_DOUBLE_WIDTH <= count; i += AVX2_DOUBLE_WIDTH) {
+    __m256d product = _mm256_mul_pd(_mm256_loadu_pd(a + i), scales);
+    _mm256_storeu_pd(accumulators + i,
+                     _mm256_add_pd(_mm256_loadu_pd(accumulators + i), product));
+  }
+#elif defined(__SSE2__)
+  __m128d scales = _mm_set1_pd(scale);
+  for (; i + SSE2_DOUBLE_WIDTH <= count; i += SSE2_DOUBLE_WIDTH) {
+    __m128d product = _mm_mul_pd(_mm_loadu_pd(a + i), scales);
+    _mm_storeu_pd(accumulators + i,
+                  _mm_add_pd(_mm_loadu_pd(accumulators + i), product));
+  }
+#endif
+  for (; i < count; i++) {
+    accumulators[i] = accumulators[i] + a[i] * scale;
+  }
+}
+
+// Returns the sum of a[i]*a[i] for i in [0, count). The pointer does not have
+// to be aligned.
+double simdKernels_sumOfSquares(const double *a, uint32_t count) {
+  double sum = INITIAL_SUM_VALUE;
+  uint32_t i = FOR_LOOP_START_VALUE;
+#if defined(__AVX2__)
+  // two accumulators so consecutive adds do not wait on each other
+  __m256d sum0 = _mm256_setzero_pd();
+  __m256d sum1 = _mm256_setzero_pd();
+  for (; i + 2 * AVX2_DOUBLE_WIDTH <= count; i += 2 * AVX2_DOUBLE_WIDTH) {
+    __m256d values0 = _mm256_loadu_pd(a + i);
+    __m256d values1 = _mm256_loadu_pd(a + i + AVX2_DOUBLE_WIDTH);
+    sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(values0, values0));
+    sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(values1, values1));
+  }
+  for (; i + AVX2_DOUBLE_WIDTH <= count; i += AVX2_DOUBLE_WIDTH) {
+    __m256d values = _mm256_loadu_pd(a + i);
+    sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(values, values));
+  }
+  sum0 = _mm256_add_pd(sum0, sum1);
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum0),
+                            _mm256_extractf128_pd(sum0, 1));
+  sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#elif defined(__SSE2__)
+  __m128d sum0 = _mm_setzero_pd();
+  __m128d sum1 = _mm_setzero_pd();
+  for (; i + 2 * SSE2_DOUBLE_WIDTH <= count; i += 2 * SSE2_DOUBLE_WIDTH) {
+    __m128d values0 = _mm_loadu_pd(a + i);
+    __m128d values1 = _mm_loadu_pd(a + i + SSE2_DOUBLE_WIDTH);
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(values0, values0));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(values1, values1));
+  }
+  sum0 = _mm_add_pd(sum0, sum1);
+  sum = _mm_cvtsd_f64(_mm_add_sd(sum0, _mm_unpackhi_pd(sum0, sum0)));
+#endif
+  // scalar loop for the fallback build and for any tail the vector loops left
+  for (; i < count; i++) {
+    sum = sum + a[i] * a[i];
+  }
+  return sum;
+}
+
+// Sets sums[i] to (sums[i] - leaving[i]*leaving[i]) + entering[i]*entering[i]
+// for i in [0, count), in that order, so the result matches the scalar
+// running power update bit for bit.
+void simdKernels_slideSumsOfSquares(double *sums, const double *entering,
+                                    const double *leaving, uint32_t count) {
+  uint32_t i = FOR_LOOP_START_VALUE;
+#if defined(__AVX2__)
+  for (; i + AVX2_DOUBLE_WIDTH <= count; i += AVX2_DOUBLE_WIDTH) {
+    __m256d enteringValues = _mm256_loadu_pd(entering + i);
+    __m256d leavingValues = _mm256_loadu_pd(leaving + i);
+    __m256d remaining = _mm256_sub_pd(
+        _mm256_loadu_pd(sums + i), _mm256_mul_pd(leavingValues, leavingValues));
+    _mm256_storeu_pd(sums + i,
+                     _mm256_add_pd(remaining, _mm256_mul_pd(enteringValues,
+                                                            enteringValues)));
+  }
+#elif defined(__SSE2__)
+  for (; i + SSE2_DOUBLE_WIDTH <= count; i += SSE2_DOUBLE_WIDTH) {
+    __m128d enteringValues = _mm_loadu_pd(entering + i);
+    __m128d leavingValues = _mm_loadu_pd(leaving + i);
+    __m128d remaining = _mm_sub_pd(_mm_loadu_pd(sums + i),
+                                   _mm_mul_pd(leavingValues, leavingValues));
+    _mm_storeu_pd(sums + i, _mm_add_pd(remaining, _mm_mul_pd(enteringValues,
+                                                             enteringValues)));
+  }
+#endif
+  for (; i < count; i++) {
+    sums[i] = (sums[i] - leaving[i] * leaving[i]) + entering[i] * entering[i];
+  }
+}
+
+// Returns the name of the instruction set the kernels were built for.
+const char *simdKernels_getInstructionSetName() {
+#if defined(__AVX2__)
+  return INSTRUCTION_SET_AVX2;
+#elif defined(__SSE2__)
+  return INSTRUCTION_SET_SSE2;
+#else
+  return INSTRUCTION_SET_SCALAR;
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef SIMDKERNELS_H_
+#define SIMDKERNELS_H_
+
+#include <stdint.h>
+
+// Vector kernels shared by the filter engines. Each kernel uses AVX2 or SSE2
+// when the compiler targets them and a plain C loop otherwise, so the same
+// code builds for the board and for host replay.
+
+// Alignment (in bytes) used for buffers handed to these kernels.
+#define SIMD_KERNELS_ALIGNMENT 32
+
+// Number of doubles processed per step by the widest kernel. Buffers sized
+// to a multiple of this never need a scalar tail.
+#define SIMD_KERNELS_DOUBLE_WIDTH 4
+
+// Rounds a count up to a multiple of SIMD_KERNELS_DOUBLE_WIDTH.
+#define SIMD_KERNELS_PADDED_COUNT(count)                                       \
+  ((((count) + SIMD_KERNELS_DOUBLE_WIDTH - 1) / SIMD_KERNELS_DOUBLE_WIDTH) *   \
+   SIMD_KERNELS_DOUBLE_WIDTH)
+
+// Returns the sum of a[i]*b[i] for i in [0, count). The pointers do not have
+// to be aligned.
+double simdKernels_dotProduct(const double *a, const double *b, uint32_t count);
+
+// Adds a[i]*b[i] to accumulators[i] for i in [0, count).
+void simdKernels_multiplyAccumulate(double *accumulators, const double *a,
+                                    const double *b, uint32_t count);
+
+// Adds a[i]*scale to accumulators[i] for i in [0, count).
+void simdKernels_scaleAccumulate(double *accumulators, const double *a,
+                                 double scale, uint32_t count);
+
+// Returns the sum of a[i]*a[i] for i in [0, count). The pointer does not have
+// to be aligned.
+double simdKernels_sumOfSquares(const double *a, uint32_t count);
+
+// Sets sums[i] to (sums[i] - leaving[i]*leaving[i]) + entering[i]*entering[i]
+// for i in [0, count), in that order, so the result matches the scalar
+// running power update bit for bit.
+void simdKernels_slideSumsOfSquares(double *sums, const double *entering,
+                                    const double *leaving, uint32_t count);
+
+// Returns the name of the instruction set the kernels were built for.
+const char *simdKernels_getInstructionSetName();
+
+#endif /* SIMDKERNELS_H_ */
@@ -0,0 +1,157 @@
+#include "slidingDft.h"
+#include "filter.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_VALUE 0.0
+#define INDEX_OFFSET 1
+
+#define WINDOW_SIZE FILTER_INPUT_PULSE_WIDTH
+
+// every step scales the bin by this much. The oldest sample in the window is
+// then weighted by 0.998 instead of 1, and a rounding error is gone after a
+// few million samples instead of staying forever
+#define DAMPING_FACTOR 0.999999
+
+// |X|^2 of a tone of amplitude A over the window is (A * 2000 / 2)^2, and the
+// 2000-sample power of the same tone is 2000 * A^2 / 2
+#define POWER_SCALE (2.0 / WINDOW_SIZE)
+
+// drift check settings. The test signal is noise plus tones at three player
+// frequencies
+#define CHECK_TONE_AMPLITUDE 0.2
+#define CHECK_TONE_PLAYER_STEP 4
+
+// rotation applied to a bin every step, damping included, and the factor the
+// sample leaving the window was multiplied by when it entered (rotated and
+// damped 2000 times since)
+static double rotationReal[FILTER_FREQUENCY_COUNT];
+static double rotationImaginary[FILTER_FREQUENCY_COUNT];
+static double leavingReal[FILTER_FREQUENCY_COUNT];
+static double leavingImaginary[FILTER_FREQUENCY_COUNT];
+
+// the complex bin at each player frequency
+static double binReal[FILTER_FREQUENCY_COUNT];
+static double binImaginary[FILTER_FREQUENCY_COUNT];
+
+// the last 2000 samples, the oldest at historyIndex
+static double history[WINDOW_SIZE];
+static uint16_t historyIndex;
+
+// Clears every bin and the input history.
+void slidingDft_init() {
+  double dampingOverWindow = pow(DAMPING_FACTOR, WINDOW_SIZE);
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    double w = TEST_SIGNAL_TWO_PI * testSignal_getCyclesPerSample(i);
+    // X[n] = x[n] + r e^-jw X[n-1] - r^N e^-jwN x[n-N]
+    rotationReal[i] = DAMPING_FACTOR * cos(w);
+    rotationImaginary[i] = -DAMPING_FACTOR * sin(w);
+    leavingReal[i] = dampingOverWindow * cos(w * WINDOW_SIZE);
+    leavingImaginary[i] = -dampingOverWindow * sin(w * WINDOW_SIZE);
+    binReal[i] = INITIAL_VALUE;
+    binImaginary[i] = INITIAL_VALUE;
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < WINDOW_SIZE; k++) {
+    history[k] = INITIAL_VALUE;
+  }
+  historyIndex = FOR_LOOP_START_VALUE;
+}
+
+// Slides every bin forward by one decimated sample.
+void slidingDft_addSample(double x) {
+  double leaving = history[historyIndex];
+  history[historyIndex] = x;
+  historyIndex++;
+  // case the index reached the end of the history, so it wraps to the start
+  if (historyIndex >= WINDOW_SIZE) {
+    historyIndex = FOR_LOOP_START_VALUE;
+  }
+
+  // the frequencies are independent, so they vectorize
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    double real = rotationReal[i] * binReal[i] -
+                  rotationImaginary[i] * binImaginary[i] + x -
+                  leavingReal[i] * leaving;
+    double imaginary = rotationReal[i] * binImaginary[i] +
+                       rotationImaginary[i] * binReal[i] -
+                       leavingImaginary[i] * leaving;
+    binReal[i] = real;
+    binImaginary[i] = imaginary;
+  }
+}
+
+// Returns the power over the last 2000 samples at the given player
+// frequency.
+double slidingDft_getPower(uint16_t filterNumber) {
+  return POWER_SCALE * (binReal[filterNumber] * binReal[filterNumber] +
+                        binImaginary[filterNumber] * binImaginary[filterNumber]);
+}
+
+// Compares the sliding DFT with DFTs computed from scratch.
+void slidingDft_runDriftCheck(uint32_t sampleCount) {
+  uint32_t noiseState = TEST_SIGNAL_NOISE_SEED;
+  double largestDampedDifference = INITIAL_VALUE;
+  double largestPlainDifference = INITIAL_VALUE;
+
+  slidingDft_init();
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < sampleCount; n++) {
+    // noise plus three tones
+    double x = TEST_SIGNAL_NOISE_AMPLITUDE * testSignal_nextNoise(&noiseState);
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+         i += CHECK_TONE_PLAYER_STEP) {
+      x += CHECK_TONE_AMPLITUDE *
+           sin(TEST_SIGNAL_TWO_PI * testSignal_getCyclesPerSample(i) * n);
+    }
+    slidingDft_addSample(x);
+
+    // case the window was just refilled, so every bin is checked
+    if ((n + INDEX_OFFSET) % WINDOW_SIZE == FOR_LOOP_START_VALUE) {
+      double dampedDifference = INITIAL_VALUE;
+      double plainDifference = INITIAL_VALUE;
+      double largestPower = INITIAL_VALUE;
+      for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT;
+           i++) {
+        double w = TEST_SIGNAL_TWO_PI * testSignal_getCyclesPerSample(i);
+        double dampedReal = INITIAL_VALUE;
+        double dampedImaginary = INITIAL_VALUE;
+        double plainReal = INITIAL_VALUE;
+        double plainImaginary = INITIAL_VALUE;
+        double weight = 1.0;
+        // m samples back from the newest, which is just before historyIndex
+        for (uint16_t m = FOR_LOOP_START_VALUE; m < WINDOW_SIZE; m++) {
+          double sample = history[(historyIndex + WINDOW_SIZE - INDEX_OFFSET -
+                                   m) % WINDOW_SIZE];
+          plainReal += sample * cos(w * m);
+          plainImaginary -= sample * sin(w * m);
+          dampedReal += weight * sample * cos(w * m);
+          dampedImaginary -= weight * sample * sin(w * m);
+          weight *= DAMPING_FACTOR;
+        }
+        double power = slidingDft_getPower(i);
+        double dampedPower = POWER_SCALE * (dampedReal * dampedReal +
+                                            dampedImaginary * dampedImaginary);
+        double plainPower = POWER_SCALE * (plainReal * plainReal +
+                                           plainImaginary * plainImaginary);
+        dampedDifference = fmax(dampedDifference, fabs(power - dampedPower));
+        plainDifference = fmax(plainDifference, fabs(power - plainPower));
+        largestPower = fmax(largestPower, plainPower);
+      }
+      // the differences are relative to the strongest bin, since a bin with
+      // almost no power has no meaningful relative error
+      largestDampedDifference =
+          fmax(largestDampedDifference, dampedDifference / largestPower);
+      largestPlainDifference =
+          fmax(largestPlainDifference, plainDifference / largestPower);
+    }
+  }
+
+  printf("sliding DFT over %u samples\n", (unsigned)sampleCount);
+  printf("largest relative difference from the damped window: %e\n",
+         largestDampedDifference);
+  printf("largest relative difference from the plain window:  %e\n",
+         largestPlainDifference);
+  slidingDft_init();
+}
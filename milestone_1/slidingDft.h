@@ -0,0 +1,34 @@
+#ifndef SLIDINGDFT_H_
+#define SLIDINGDFT_H_
+
+#include <stdint.h>
+
+// Tracks the DFT of the last 2000 decimated FIR outputs at each of the 10
+// player frequencies, in place of the IIR filters and filter_computePower.
+// Every sample costs one complex multiply-add per frequency, and the power
+// is available after every sample.
+//
+// Each bin keeps a complex value and its rotation constants. The sample
+// leaving the window is taken from one input history shared by all bins,
+// which replaces the 10 2000-sample output queues. The recursion is damped
+// by a factor just below 1 so rounding errors die out instead of building
+// up. The power is scaled like goertzel_getPower.
+
+// Clears every bin and the input history.
+void slidingDft_init();
+
+// Slides every bin forward by one decimated sample.
+void slidingDft_addSample(double x);
+
+// Returns the power over the last 2000 samples at the given player
+// frequency.
+double slidingDft_getPower(uint16_t filterNumber);
+
+// Runs sampleCount samples of noise with player tones through the sliding
+// DFT and, every 2000 samples, compares each bin with a DFT computed from
+// scratch over the same window, with and without the damping. Prints the
+// largest power difference seen, relative to the strongest bin.
+// Reinitializes the sliding DFT.
+void slidingDft_runDriftCheck(uint32_t sampleCount);
+
+#endif /* SLIDINGDFT_H_ */
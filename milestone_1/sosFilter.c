@@ -0,0 +1,386 @@
+#include "sosFilter.h"
+#include "coef.h"
+#include "filter.h"
+#include "testSignal.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INITIAL_STATE_VALUE 0.0f
+#define INITIAL_SUM_VALUE 0.0
+#define INDEX_OFFSET 1
+
+// the 10th order denominator of every filter splits into one quadratic
+// factor per section
+#define FACTOR_DEGREE 2
+#if (SOS_FILTER_SECTION_COUNT * FACTOR_DEGREE !=                              \
+     IIR_A_COEFFICIENT_COUNT - INDEX_OFFSET) ||                                \
+    (IIR_B_COEFFICIENT_COUNT != IIR_A_COEFFICIENT_COUNT)
+#error "coef.h does not have the shape sosFilter.c splits into sections"
+#endif
+#define POLYNOMIAL_DEGREE (IIR_A_COEFFICIENT_COUNT - INDEX_OFFSET)
+#define LEADING_COEFFICIENT 1.0
+
+// Bairstow's method settings. Every quadratic factor is first found on the
+// polynomial left after the earlier ones were divided out, starting from a
+// pole pair at FACTOR_START_RADIUS and the filter's center frequency, which
+// is where all of the poles cluster. It is then refined on the full
+// polynomial, so the rounding of the divisions does not carry over into it
+#define FACTOR_START_RADIUS 0.98
+#define FACTOR_ITERATION_LIMIT 100
+#define FACTOR_TOLERANCE 1e-15
+#define FACTOR_START_U_SCALE -2.0
+#define SINE_OF_DOUBLE_ANGLE_SCALE 2.0
+#define ANGLE_DOUBLING 2.0
+#define SECTION_GAIN_ROOT (1.0 / SOS_FILTER_SECTION_COUNT)
+#define FIRST_SECTION 0
+
+// each section is transposed direct form II with two state values
+#define SOS_STATE_COUNT 2
+#define SOS_STATE_1 0
+#define SOS_STATE_2 1
+
+// report settings. Each test signal is the burst signal of one player with
+// the burst on throughout, run at the 10 kHz decimated rate
+#define REPORT_SAMPLE_COUNT 20000
+#define REPORT_POWER_WINDOW 2000
+#define REPORT_BURST_ON true
+
+// direct form reference history: newest value first
+#define REFERENCE_Y_COUNT IIR_B_COEFFICIENT_COUNT
+#define REFERENCE_Z_COUNT (IIR_A_COEFFICIENT_COUNT - INDEX_OFFSET)
+
+// sections of every filter, computed by the first sosFilter_init
+static float sosCoefficients[FILTER_FREQUENCY_COUNT][SOS_FILTER_SECTION_COUNT]
+                           [SOS_FILTER_COEFFICIENT_COUNT];
+static bool sosCoefficientsComputed = false;
+
+// state of every section of every filter
+static float sosState[FILTER_FREQUENCY_COUNT][SOS_FILTER_SECTION_COUNT]
+                     [SOS_STATE_COUNT];
+
+// refines the quadratic factor z^2 + u z + v of the polynomial whose
+// coefficient k multiplies z^k with Bairstow's method. The polynomial is
+// monic and of the given degree, which is above 2
+static void refineQuadraticFactor(const double polynomial[], uint16_t degree,
+                                  double *u, double *v);
+
+// divides the monic polynomial of the given degree by z^2 + u z + v in place
+// and drops the remainder, leaving the quotient in the low coefficients
+static void divideOutQuadraticFactor(double polynomial[], uint16_t degree,
+                                     double u, double v);
+
+// returns the magnitude of 1 + a1 z^-1 + a2 z^-2 at z = e^(j w)
+static double quadraticMagnitude(double a1, double a2, double w);
+
+// runs the test signal for one player through every filter and updates the
+// worst errors seen for each filter
+static void compareWithReference(uint16_t player, double worstPowerError[],
+                                 double worstOutputError[]);
+
+// Computes the sections of one filter in double from its coef.h rows.
+void sosFilter_computeSections(
+    uint16_t filterNumber,
+    double sections[SOS_FILTER_SECTION_COUNT][SOS_FILTER_COEFFICIENT_COUNT]) {
+  // the denominator z^10 + a1 z^9 + ... + a10, coefficient k multiplying z^k,
+  // and what is left of it as the sections are divided out
+  double polynomial[IIR_A_COEFFICIENT_COUNT];
+  double remaining[IIR_A_COEFFICIENT_COUNT];
+  double w = TEST_SIGNAL_TWO_PI * testSignal_getCyclesPerSample(filterNumber);
+  double startU = FACTOR_START_U_SCALE * FACTOR_START_RADIUS * cos(w);
+  double startV = FACTOR_START_RADIUS * FACTOR_START_RADIUS;
+
+  polynomial[POLYNOMIAL_DEGREE] = LEADING_COEFFICIENT;
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < POLYNOMIAL_DEGREE; k++) {
+    polynomial[POLYNOMIAL_DEGREE - INDEX_OFFSET - k] =
+        iirACoefficientConstants[filterNumber][k];
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < IIR_A_COEFFICIENT_COUNT; k++) {
+    remaining[k] = polynomial[k];
+  }
+
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+    uint16_t degree = POLYNOMIAL_DEGREE - FACTOR_DEGREE * s;
+    double u = startU;
+    double v = startV;
+    // case more than one factor is left, so it is searched for
+    if (degree > FACTOR_DEGREE) {
+      refineQuadraticFactor(remaining, degree, &u, &v);
+      divideOutQuadraticFactor(remaining, degree, u, v);
+      refineQuadraticFactor(polynomial, POLYNOMIAL_DEGREE, &u, &v);
+    }
+    // otherwise the last factor is what is left
+    else {
+      u = remaining[INDEX_OFFSET];
+      v = remaining[FOR_LOOP_START_VALUE];
+      refineQuadraticFactor(polynomial, POLYNOMIAL_DEGREE, &u, &v);
+    }
+
+    // insertion sort into increasing pole radius, which is the square root
+    // of a2
+    uint16_t k = s;
+    while ((k > FOR_LOOP_START_VALUE) &&
+           (sections[k - INDEX_OFFSET][SOS_FILTER_A2] > v)) {
+      sections[k][SOS_FILTER_A1] = sections[k - INDEX_OFFSET][SOS_FILTER_A1];
+      sections[k][SOS_FILTER_A2] = sections[k - INDEX_OFFSET][SOS_FILTER_A2];
+      k--;
+    }
+    sections[k][SOS_FILTER_A1] = u;
+    sections[k][SOS_FILTER_A2] = v;
+  }
+
+  // every section gets the same gain at the center frequency, so the signal
+  // keeps about the same size through the cascade. |1 - e^(-2jw)| = 2 sin(w)
+  double numeratorMagnitude = SINE_OF_DOUBLE_ANGLE_SCALE * sin(w);
+  double b0 = iirBCoefficientConstants[filterNumber][FOR_LOOP_START_VALUE];
+  double totalGain = fabs(b0);
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+    totalGain = totalGain * numeratorMagnitude /
+                quadraticMagnitude(sections[s][SOS_FILTER_A1],
+                                   sections[s][SOS_FILTER_A2], w);
+  }
+  double sectionGain = pow(totalGain, SECTION_GAIN_ROOT);
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+    double scale = sectionGain *
+                   quadraticMagnitude(sections[s][SOS_FILTER_A1],
+                                      sections[s][SOS_FILTER_A2], w) /
+                   numeratorMagnitude;
+    // case this is the first section, which also carries the sign of b0
+    if (s == FIRST_SECTION) {
+      scale = copysign(scale, b0);
+    }
+    sections[s][SOS_FILTER_B0] = scale;
+    sections[s][SOS_FILTER_B1] = INITIAL_SUM_VALUE;
+    sections[s][SOS_FILTER_B2] = -scale;
+  }
+}
+
+// Clears the state of every section. The first call also computes the
+// sections.
+void sosFilter_init() {
+  // case this is the first call, so the sections are computed
+  if (!sosCoefficientsComputed) {
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      double sections[SOS_FILTER_SECTION_COUNT][SOS_FILTER_COEFFICIENT_COUNT];
+      sosFilter_computeSections(i, sections);
+      for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT;
+           s++) {
+        for (uint16_t c = FOR_LOOP_START_VALUE;
+             c < SOS_FILTER_COEFFICIENT_COUNT; c++) {
+          sosCoefficients[i][s][c] = (float)sections[s][c];
+        }
+      }
+    }
+    sosCoefficientsComputed = true;
+  }
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+      sosState[i][s][SOS_STATE_1] = INITIAL_STATE_VALUE;
+      sosState[i][s][SOS_STATE_2] = INITIAL_STATE_VALUE;
+    }
+  }
+}
+
+// Runs one decimated sample through one filter and returns its output.
+float sosFilter_filter(uint16_t filterNumber, float x) {
+  // the output of each section is the input of the next one
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SOS_FILTER_SECTION_COUNT; s++) {
+    const float *c = sosCoefficients[filterNumber][s];
+    float *state = sosState[filterNumber][s];
+    float y = c[SOS_FILTER_B0] * x + state[SOS_STATE_1];
+    state[SOS_STATE_1] =
+        c[SOS_FILTER_B1] * x - c[SOS_FILTER_A1] * y + state[SOS_STATE_2];
+    state[SOS_STATE_2] = c[SOS_FILTER_B2] * x - c[SOS_FILTER_A2] * y;
+    x = y;
+  }
+  return x;
+}
+
+// Runs one decimated sample through all 10 filters.
+void sosFilter_filterBank(float x, float outputs[]) {
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    outputs[i] = sosFilter_filter(i, x);
+  }
+}
+
+// Runs test signals through the float biquads and a double direct form
+// reference of the coef.h filters and prints the worst errors per filter.
+void sosFilter_runAccuracyReport() {
+  double worstPowerError[FILTER_FREQUENCY_COUNT];
+  double worstOutputError[FILTER_FREQUENCY_COUNT];
+
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    worstPowerError[i] = INITIAL_SUM_VALUE;
+    worstOutputError[i] = INITIAL_SUM_VALUE;
+  }
+  // one test signal per player frequency, so every filter sees its own tone
+  // as well as tones in its stopband
+  for (uint16_t player = FOR_LOOP_START_VALUE; player < FILTER_FREQUENCY_COUNT;
+       player++) {
+    compareWithReference(player, worstPowerError, worstOutputError);
+  }
+
+  printf("float biquads against double direct form\n");
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    printf("  filter %d: worst relative power error %e, worst output error "
+           "%e of the output RMS\n",
+           i, worstPowerError[i], worstOutputError[i]);
+  }
+  sosFilter_init();
+}
+
+// runs the test signal for one player through every filter and updates the
+// worst errors seen for each filter
+static void compareWithReference(uint16_t player, double worstPowerError[],
+                                 double worstOutputError[]) {
+  double yHistory[REFERENCE_Y_COUNT];
+  double zHistory[FILTER_FREQUENCY_COUNT][REFERENCE_Z_COUNT];
+  // power of both outputs over the current window, the squared output of the
+  // whole run and the largest output difference
+  double referencePower[FILTER_FREQUENCY_COUNT];
+  double sosPower[FILTER_FREQUENCY_COUNT];
+  double referenceEnergy[FILTER_FREQUENCY_COUNT];
+  double largestOutputDifference[FILTER_FREQUENCY_COUNT];
+  testSignal_t signal;
+  testSignal_init(&signal, player, FILTER_FIR_DECIMATION_FACTOR);
+
+  sosFilter_init();
+  for (uint16_t k = FOR_LOOP_START_VALUE; k < REFERENCE_Y_COUNT; k++) {
+    yHistory[k] = INITIAL_SUM_VALUE;
+  }
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    for (uint16_t k = FOR_LOOP_START_VALUE; k < REFERENCE_Z_COUNT; k++) {
+      zHistory[i][k] = INITIAL_SUM_VALUE;
+    }
+    referencePower[i] = INITIAL_SUM_VALUE;
+    sosPower[i] = INITIAL_SUM_VALUE;
+    referenceEnergy[i] = INITIAL_SUM_VALUE;
+    largestOutputDifference[i] = INITIAL_SUM_VALUE;
+  }
+
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < REPORT_SAMPLE_COUNT; n++) {
+    double x = testSignal_getSample(&signal, n, REPORT_BURST_ON);
+
+    for (uint16_t k = REFERENCE_Y_COUNT - INDEX_OFFSET; k > 0; k--) {
+      yHistory[k] = yHistory[k - INDEX_OFFSET];
+    }
+    yHistory[FOR_LOOP_START_VALUE] = x;
+
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+      // the same sums filter_iirFilter computes, in double
+      double reference = INITIAL_SUM_VALUE;
+      for (uint16_t k = FOR_LOOP_START_VALUE; k < REFERENCE_Y_COUNT; k++) {
+        reference = reference + iirBCoefficientConstants[i][k] * yHistory[k];
+      }
+      for (uint16_t k = FOR_LOOP_START_VALUE; k < REFERENCE_Z_COUNT; k++) {
+        reference = reference - iirACoefficientConstants[i][k] * zHistory[i][k];
+      }
+      for (uint16_t k = REFERENCE_Z_COUNT - INDEX_OFFSET; k > 0; k--) {
+        zHistory[i][k] = zHistory[i][k - INDEX_OFFSET];
+      }
+      zHistory[i][FOR_LOOP_START_VALUE] = reference;
+      double output = sosFilter_filter(i, (float)x);
+
+      referencePower[i] += reference * reference;
+      sosPower[i] += output * output;
+      referenceEnergy[i] += reference * reference;
+      largestOutputDifference[i] =
+          fmax(largestOutputDifference[i], fabs(output - reference));
+
+      // case a power window just finished, so the powers are compared and
+      // the next window starts from zero
+      if ((n + INDEX_OFFSET) % REPORT_POWER_WINDOW == FOR_LOOP_START_VALUE) {
+        double powerError =
+            fabs(sosPower[i] - referencePower[i]) / referencePower[i];
+        worstPowerError[i] = fmax(worstPowerError[i], powerError);
+        referencePower[i] = INITIAL_SUM_VALUE;
+        sosPower[i] = INITIAL_SUM_VALUE;
+      }
+    }
+  }
+
+  // the output error is given as a fraction of the reference RMS
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    double referenceRms = sqrt(referenceEnergy[i] / REPORT_SAMPLE_COUNT);
+    worstOutputError[i] =
+        fmax(worstOutputError[i], largestOutputDifference[i] / referenceRms);
+  }
+}
+
+// refines the quadratic factor z^2 + u z + v of the polynomial with
+// Bairstow's method: Newton's method on the two coefficients of the remainder
+// of the division by the factor
+static void refineQuadraticFactor(const double polynomial[], uint16_t degree,
+                                  double *u, double *v) {
+  for (uint16_t iteration = FOR_LOOP_START_VALUE;
+       iteration < FACTOR_ITERATION_LIMIT; iteration++) {
+    // quotient[k] multiplies z^k of the quotient of the division by the
+    // factor, and derivative[k] of the quotient of that quotient by the
+    // factor again. Both are zero past their top coefficient
+    double quotient[IIR_A_COEFFICIENT_COUNT + FACTOR_DEGREE];
+    double derivative[IIR_A_COEFFICIENT_COUNT + FACTOR_DEGREE];
+    quotient[degree] = INITIAL_SUM_VALUE;
+    quotient[degree - INDEX_OFFSET] = INITIAL_SUM_VALUE;
+    derivative[degree - FACTOR_DEGREE] = INITIAL_SUM_VALUE;
+    derivative[degree - FACTOR_DEGREE - INDEX_OFFSET] = INITIAL_SUM_VALUE;
+    for (int16_t k = degree - FACTOR_DEGREE; k >= FOR_LOOP_START_VALUE; k--) {
+      quotient[k] = polynomial[k + FACTOR_DEGREE] -
+                    *u * quotient[k + INDEX_OFFSET] -
+                    *v * quotient[k + FACTOR_DEGREE];
+    }
+    for (int16_t k = degree - FACTOR_DEGREE - FACTOR_DEGREE;
+         k >= FOR_LOOP_START_VALUE; k--) {
+      derivative[k] = quotient[k + FACTOR_DEGREE] -
+                      *u * derivative[k + INDEX_OFFSET] -
+                      *v * derivative[k + FACTOR_DEGREE];
+    }
+    // the remainder c z + d and its derivatives with respect to u and v
+    double c = polynomial[INDEX_OFFSET] - *u * quotient[FOR_LOOP_START_VALUE] -
+               *v * quotient[INDEX_OFFSET];
+    double d = polynomial[FOR_LOOP_START_VALUE] -
+               *v * quotient[FOR_LOOP_START_VALUE];
+    double g = quotient[INDEX_OFFSET] - *u * derivative[FOR_LOOP_START_VALUE] -
+               *v * derivative[INDEX_OFFSET];
+    double h = quotient[FOR_LOOP_START_VALUE] -
+               *v * derivative[FOR_LOOP_START_VALUE];
+    double determinant = *v * g * g + h * (h - *u * g);
+    // case the step cannot be taken, so the factor is as good as it gets
+    if (determinant == INITIAL_SUM_VALUE) {
+      return;
+    }
+    double du = (-h * c + g * d) / determinant;
+    double dv = (-g * *v * c + (g * *u - h) * d) / determinant;
+    *u = *u - du;
+    *v = *v - dv;
+    // case the step was down to rounding, so the factor has converged
+    if (fabs(du) + fabs(dv) < FACTOR_TOLERANCE) {
+      return;
+    }
+  }
+}
+
+// divides the monic polynomial by z^2 + u z + v in place and drops the
+// remainder
+static void divideOutQuadraticFactor(double polynomial[], uint16_t degree,
+                                     double u, double v) {
+  double quotient[IIR_A_COEFFICIENT_COUNT + FACTOR_DEGREE];
+  quotient[degree] = INITIAL_SUM_VALUE;
+  quotient[degree - INDEX_OFFSET] = INITIAL_SUM_VALUE;
+  for (int16_t k = degree - FACTOR_DEGREE; k >= FOR_LOOP_START_VALUE; k--) {
+    quotient[k] = polynomial[k + FACTOR_DEGREE] -
+                  u * quotient[k + INDEX_OFFSET] -
+                  v * quotient[k + FACTOR_DEGREE];
+  }
+  for (uint16_t k = FOR_LOOP_START_VALUE; k <= degree - FACTOR_DEGREE; k++) {
+    polynomial[k] = quotient[k];
+  }
+}
+
+// returns the magnitude of 1 + a1 z^-1 + a2 z^-2 at z = e^(j w)
+static double quadraticMagnitude(double a1, double a2, double w) {
+  double real =
+      LEADING_COEFFICIENT + a1 * cos(w) + a2 * cos(ANGLE_DOUBLING * w);
+  double imaginary = a1 * sin(w) + a2 * sin(ANGLE_DOUBLING * w);
+  return sqrt(real * real + imaginary * imaginary);
+}
@@ -0,0 +1,54 @@
+#ifndef SOSFILTER_H_
+#define SOSFILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs the 10 IIR filters from coef.h as cascades of 5 second order sections
+// (biquads) in float. The 10th order direct form needs double precision,
+// but each biquad only has a-coefficients below 2, so float is enough.
+//
+// The sections are computed from the direct form rows of coef.h rather than
+// kept in a table of their own, so they always match them. Each section holds
+// one conjugate pole pair, found as a quadratic factor of the row of
+// iirACoefficientConstants, and one (1 - z^-2) factor of the b0 (1 - z^-2)^5
+// numerator every row of iirBCoefficientConstants holds. b0 is split so every
+// section has the same gain at the filter's center frequency, and the
+// sections run in order of increasing pole radius.
+
+// number of sections per filter and of coefficients per section
+#define SOS_FILTER_SECTION_COUNT 5
+#define SOS_FILTER_COEFFICIENT_COUNT 5
+
+// positions of the coefficients within one section, {b0, b1, b2, a1, a2} for
+// (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+#define SOS_FILTER_B0 0
+#define SOS_FILTER_B1 1
+#define SOS_FILTER_B2 2
+#define SOS_FILTER_A1 3
+#define SOS_FILTER_A2 4
+
+// Computes the sections of one filter in double from its coef.h rows. The
+// float sections are rounded from these, and the fixed point chain quantizes
+// them to its own format.
+void sosFilter_computeSections(
+    uint16_t filterNumber,
+    double sections[SOS_FILTER_SECTION_COUNT][SOS_FILTER_COEFFICIENT_COUNT]);
+
+// Clears the state of every section. The first call also computes the
+// sections.
+void sosFilter_init();
+
+// Runs one decimated sample through one filter and returns its output.
+float sosFilter_filter(uint16_t filterNumber, float x);
+
+// Runs one decimated sample through all 10 filters. outputs must hold 10
+// values.
+void sosFilter_filterBank(float x, float outputs[]);
+
+// Runs test signals through the float biquads and a double direct form
+// reference of the coef.h filters and prints, for each filter, the largest
+// relative error of the 2000-sample power and of the output.
+void sosFilter_runAccuracyReport();
+
+#endif /* SOSFILTER_H_ */
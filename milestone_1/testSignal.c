@@ -0,0 +1,80 @@
+#include "testSignal.h"
+
+#include <math.h>
+
+#define FOR_LOOP_START_VALUE 0
+#define INDEX_OFFSET 1
+
+#define NOISE_MULTIPLIER 1103515245
+#define NOISE_INCREMENT 12345
+#define NOISE_RANGE 4294967296.0
+#define NOISE_CENTER 0.5
+
+#define HALF_PERIOD_DIVISOR 2
+#define MEDIAN_INDEX 4
+
+// Returns the next value of the noise generator, evenly spread over [0, 1).
+double testSignal_nextUniform(uint32_t *noiseState) {
+  *noiseState = *noiseState * NOISE_MULTIPLIER + NOISE_INCREMENT;
+  return *noiseState / NOISE_RANGE;
+}
+
+// Returns the next value of the noise generator, evenly spread over
+// [-0.5, 0.5).
+double testSignal_nextNoise(uint32_t *noiseState) {
+  return testSignal_nextUniform(noiseState) - NOISE_CENTER;
+}
+
+// Returns the frequency of a player in cycles per decimated sample.
+double testSignal_getCyclesPerSample(uint16_t player) {
+  return TEST_SIGNAL_CYCLES_PER_SAMPLE_NUMERATOR /
+         filter_frequencyTickTable[player];
+}
+
+// Starts the burst signal of a player.
+void testSignal_init(testSignal_t *signal, uint16_t player,
+                     uint16_t decimationFactor) {
+  signal->noiseState = TEST_SIGNAL_NOISE_SEED;
+  signal->period =
+      filter_frequencyTickTable[player] / (double)decimationFactor;
+}
+
+// Returns sample n of the burst signal: noise, plus the square wave if
+// burstOn.
+double testSignal_getSample(testSignal_t *signal, uint32_t n, bool burstOn) {
+  double x =
+      TEST_SIGNAL_NOISE_AMPLITUDE * testSignal_nextNoise(&signal->noiseState);
+  // case the square wave is on
+  if (burstOn) {
+    x += (fmod(n, signal->period) < signal->period / HALF_PERIOD_DIVISOR)
+             ? TEST_SIGNAL_SQUARE_AMPLITUDE
+             : -TEST_SIGNAL_SQUARE_AMPLITUDE;
+  }
+  return x;
+}
+
+// Returns the player whose power is above fudgeFactor times the median of the
+// 10 powers, or TEST_SIGNAL_NO_HIT.
+uint16_t testSignal_findHit(const double powers[], double fudgeFactor) {
+  double sorted[FILTER_FREQUENCY_COUNT];
+  uint16_t maxPlayer = FOR_LOOP_START_VALUE;
+  // insertion sort into ascending order, keeping track of the largest
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < FILTER_FREQUENCY_COUNT; i++) {
+    uint16_t k = i;
+    while ((k > FOR_LOOP_START_VALUE) &&
+           (sorted[k - INDEX_OFFSET] > powers[i])) {
+      sorted[k] = sorted[k - INDEX_OFFSET];
+      k--;
+    }
+    sorted[k] = powers[i];
+    if (powers[i] > powers[maxPlayer]) {
+      maxPlayer = i;
+    }
+  }
+  // case the largest power is far enough above the median
+  if (sorted[FILTER_FREQUENCY_COUNT - INDEX_OFFSET] >
+      fudgeFactor * sorted[MEDIAN_INDEX]) {
+    return maxPlayer;
+  }
+  return TEST_SIGNAL_NO_HIT;
+}
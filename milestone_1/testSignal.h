@@ -0,0 +1,61 @@
+#ifndef TESTSIGNAL_H_
+#define TESTSIGNAL_H_
+
+#include "filter.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Test signals and hit decisions shared by the reports and benchmarks of the
+// filter modules, so they all run on the same signal and judge it the same
+// way. The noise comes from a linear congruential generator, so every run
+// sees the same samples. A burst signal is that noise plus, while a burst is
+// on, a square wave at one player frequency, which is what a shot looks like.
+
+#define TEST_SIGNAL_TWO_PI 6.283185307179586
+
+// the player frequencies are 100 kHz / ticks, so on the 10 kHz decimated
+// signal a player's frequency is 10 / ticks cycles per sample
+#define TEST_SIGNAL_CYCLES_PER_SAMPLE_NUMERATOR 10.0
+
+// first state of the noise generator
+#define TEST_SIGNAL_NOISE_SEED 12345
+
+// amplitudes of the square wave and the noise of a burst signal
+#define TEST_SIGNAL_SQUARE_AMPLITUDE 0.3
+#define TEST_SIGNAL_NOISE_AMPLITUDE 0.05
+
+// returned by testSignal_findHit when no player stands out
+#define TEST_SIGNAL_NO_HIT FILTER_FREQUENCY_COUNT
+
+typedef struct {
+  uint32_t noiseState; // state of the noise generator
+  double period;       // period of the square wave, in samples
+} testSignal_t;
+
+// Returns the next value of the noise generator, evenly spread over [0, 1).
+double testSignal_nextUniform(uint32_t *noiseState);
+
+// Returns the next value of the noise generator, evenly spread over
+// [-0.5, 0.5).
+double testSignal_nextNoise(uint32_t *noiseState);
+
+// Returns the frequency of a player in cycles per decimated sample.
+double testSignal_getCyclesPerSample(uint16_t player);
+
+// Starts the burst signal of a player. The square wave has the player's
+// period at the ADC rate divided by decimationFactor, so 1 gives a signal at
+// the ADC rate and FILTER_FIR_DECIMATION_FACTOR one at the decimated rate.
+void testSignal_init(testSignal_t *signal, uint16_t player,
+                     uint16_t decimationFactor);
+
+// Returns sample n of the burst signal: noise, plus the square wave if
+// burstOn. Advances the noise, so it is called once for every sample in
+// order.
+double testSignal_getSample(testSignal_t *signal, uint32_t n, bool burstOn);
+
+// Returns the player whose power is above fudgeFactor times the median of the
+// 10 powers, or TEST_SIGNAL_NO_HIT.
+uint16_t testSignal_findHit(const double powers[], double fudgeFactor);
+
+#endif /* TESTSIGNAL_H_ */
@@ -1,14 +1,13 @@
 #include "trigger.h"
 #include "buttons.h"
+#include "inputSampler.h"
 #include "intervalTimer.h"
 #include "mio.h"
 #include "switches.h"
 #include "transmitter.h"
 #include "utils.h"
 #include <stdio.h>
-// pin number and state macros
-#define TRIGGER_PIN 10
-#define TRIGGER_PRESSED 1
+// pin state macro. The pin number and pressed level are in inputSampler.h
 #define TRIGGER_NOT_PRESSED 0
 // initial counter value
 #define TRIGGER_COUNTER_INITIAL_VALUE 0
@@ -56,7 +55,7 @@ uint16_t triggerGetCurrentFrequency();
 void trigger_init() {
   resetTriggerCounter();
   mio_init(false);
-  mio_setPinAsInput(TRIGGER_PIN);
+  mio_setPinAsInput(INPUT_SAMPLER_TRIGGER_PIN);
   buttons_init();
 }
 
@@ -203,10 +202,13 @@ bool triggerCounterIsDone() { return (triggerCounter >= DEBOUNCE_TICK_DELAY); }
 
 // returns whether or not the trigger is currently pressed
 bool triggerPressed() {
+  // the pin and buttons come from the latest input snapshot, which the ISR
+  // takes at a much lower rate than this runs
+  uint32_t snapshot = inputSampler_getSnapshot();
   // checks the value of the trigger pin. If it is pressed
   // then we return a true. or if button_0 is also pressed
-  if ((mio_readPin(TRIGGER_PIN) == TRIGGER_PRESSED) ||
-      (buttons_read() & BUTTONS_BTN0_MASK)) {
+  if (inputSampler_getTriggerPin(snapshot) ||
+      (inputSampler_getButtons(snapshot) & BUTTONS_BTN0_MASK)) {
     return true;
   }
   // checks the value of the trigger pin. If it is not pressed
@@ -220,7 +222,7 @@ bool triggerPressed() {
 //returns the current setting of the switches with a default for ignored frequencies
 uint16_t triggerGetCurrentFrequency()
 {
-  uint16_t switchSetting = switches_read() & SWITCHES_BIT_MASK; // Bit-mask the results.
+  uint16_t switchSetting = inputSampler_getSwitches(inputSampler_getSnapshot());
   // Provide a nice default if the slide switches are in error.
   if (!(switchSetting < NUM_FREQUENCIES))
   {
@@ -0,0 +1,291 @@
+#include "adcRing.h"
+
+#include <string.h>
+
+#ifdef ADC_RING_STRESS_TEST
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+#define INDEX_IN_INITIAL_VALUE 0
+#define INDEX_OUT_INITIAL_VALUE 0
+#define INDEX_IN_OFFSET 1
+#define DROP_COUNT_INITIAL_VALUE 0
+#define DROP_COUNT_INCREMENT 1
+
+// settings of adcRing_runStressTest. Both buffers have as many slots as the
+// ISR's ADC buffer, and the critical sections of the locked buffer are taken
+// with a mutex in place of disabling interrupts
+#define STRESS_TEST_RING_SIZE 100000
+#define STRESS_TEST_VALUE_COUNT 20000000
+#define STRESS_TEST_BLOCK_SIZE 100
+#define STRESS_TEST_COUNT_INITIAL_VALUE 0
+#define STRESS_TEST_VALUE_OFFSET 1
+#define NANOSECONDS_PER_SECOND 1000000000.0
+#define VALUES_PER_MILLION 1000000.0
+
+// Empties the ring and makes it use the size slots of data, which the caller
+// allocates. The slots are not cleared, they are written before they are
+// read.
+void adcRing_init(adcRing_t *ring, uint32_t data[], uint32_t size) {
+  ring->data = data;
+  ring->size = size;
+  ring->indexIn = INDEX_IN_INITIAL_VALUE;
+  ring->indexOut = INDEX_OUT_INITIAL_VALUE;
+  ring->dropCount = DROP_COUNT_INITIAL_VALUE;
+}
+
+// Adds a value, or drops and counts it if the ring is full. Only the
+// producer may call this.
+void adcRing_add(adcRing_t *ring, uint32_t value) {
+  // the producer owns indexIn, so its own copy needs no ordering
+  uint32_t indexIn = __atomic_load_n(&ring->indexIn, __ATOMIC_RELAXED);
+  uint32_t nextIndexIn = indexIn + INDEX_IN_OFFSET;
+  // case the index reached the end of the data array, so it wraps around
+  if (nextIndexIn >= ring->size) {
+    nextIndexIn = INDEX_IN_INITIAL_VALUE;
+  }
+  // case the ring is full. The slot the consumer reads next is still its
+  // own, so the new value is dropped and counted
+  if (nextIndexIn == __atomic_load_n(&ring->indexOut, __ATOMIC_ACQUIRE)) {
+    __atomic_store_n(&ring->dropCount, ring->dropCount + DROP_COUNT_INCREMENT,
+                     __ATOMIC_RELAXED);
+    return;
+  }
+  ring->data[indexIn] = value;
+  // publishes the value. The release store keeps the data write above from
+  // being seen after the new index
+  __atomic_store_n(&ring->indexIn, nextIndexIn, __ATOMIC_RELEASE);
+}
+
+// Removes up to maxCount of the oldest values into destination, oldest first,
+// and returns how many were removed. Only the consumer may call this.
+uint32_t adcRing_removeBlock(adcRing_t *ring, uint32_t destination[],
+                             uint32_t maxCount) {
+  uint32_t indexOut = __atomic_load_n(&ring->indexOut, __ATOMIC_RELAXED);
+  // the acquire load makes every value before indexIn visible
+  uint32_t indexIn = __atomic_load_n(&ring->indexIn, __ATOMIC_ACQUIRE);
+  uint32_t count = (indexIn >= indexOut) ? (indexIn - indexOut)
+                                         : (indexIn + ring->size - indexOut);
+  // case there are fewer values than asked for
+  if (count > maxCount) {
+    count = maxCount;
+  }
+  // values between indexOut and the end of the data array, then the rest from
+  // the start of it
+  uint32_t firstCount = ring->size - indexOut;
+  if (firstCount > count) {
+    firstCount = count;
+  }
+  memcpy(destination, &ring->data[indexOut], firstCount * sizeof(uint32_t));
+  memcpy(&destination[firstCount], ring->data,
+         (count - firstCount) * sizeof(uint32_t));
+
+  indexOut = indexOut + count;
+  // case the copy went past the end of the data array
+  if (indexOut >= ring->size) {
+    indexOut = indexOut - ring->size;
+  }
+  // hands the slots back to the producer only after they have been copied
+  __atomic_store_n(&ring->indexOut, indexOut, __ATOMIC_RELEASE);
+  return count;
+}
+
+// Returns the number of values in the ring.
+uint32_t adcRing_elementCount(adcRing_t *ring) {
+  uint32_t indexOut = __atomic_load_n(&ring->indexOut, __ATOMIC_ACQUIRE);
+  uint32_t indexIn = __atomic_load_n(&ring->indexIn, __ATOMIC_ACQUIRE);
+  return (indexIn >= indexOut) ? (indexIn - indexOut)
+                               : (indexIn + ring->size - indexOut);
+}
+
+// Returns how many values the producer dropped because the ring was full.
+uint32_t adcRing_getDropCount(adcRing_t *ring) {
+  return __atomic_load_n(&ring->dropCount, __ATOMIC_RELAXED);
+}
+
+#ifdef ADC_RING_STRESS_TEST
+// storage shared by the two buffers, which are never run at the same time
+static uint32_t stressTestRingData[STRESS_TEST_RING_SIZE]
+    __attribute__((aligned(ADC_RING_CACHE_LINE_SIZE)));
+static adcRing_t stressTestRing;
+
+// host copy of the locked buffer in isr.c, which includes board headers and
+// so cannot be linked here. When it is full the oldest value is overwritten
+// and counted, and both sides take the lock for every call, as the ISR runs
+// with interrupts off and the detector turns them off around its reads
+typedef struct {
+  uint32_t indexIn;
+  uint32_t indexOut;
+  uint32_t elementCount;
+  uint32_t dropCount;
+} stressTestLockedBuffer_t;
+
+static stressTestLockedBuffer_t stressTestLockedBuffer;
+
+// whether the run uses the locked buffer instead of the ring
+static bool stressTestLocked;
+
+// stands in for disabling interrupts
+static pthread_mutex_t stressTestLock = PTHREAD_MUTEX_INITIALIZER;
+
+// set by the producer once it has added every value
+static bool stressTestProducerDone;
+
+// adds a value to the locked buffer, overwriting the oldest one if it is full
+static void stressTestLockedAdd(uint32_t value) {
+  pthread_mutex_lock(&stressTestLock);
+  // case the buffer is full, so the oldest value is dropped
+  if (stressTestLockedBuffer.elementCount ==
+      STRESS_TEST_RING_SIZE - INDEX_IN_OFFSET) {
+    stressTestLockedBuffer.indexOut =
+        (stressTestLockedBuffer.indexOut + INDEX_IN_OFFSET) %
+        STRESS_TEST_RING_SIZE;
+    stressTestLockedBuffer.elementCount--;
+    stressTestLockedBuffer.dropCount =
+        stressTestLockedBuffer.dropCount + DROP_COUNT_INCREMENT;
+  }
+  stressTestRingData[stressTestLockedBuffer.indexIn] = value;
+  stressTestLockedBuffer.elementCount++;
+  stressTestLockedBuffer.indexIn =
+      (stressTestLockedBuffer.indexIn + INDEX_IN_OFFSET) %
+      STRESS_TEST_RING_SIZE;
+  pthread_mutex_unlock(&stressTestLock);
+}
+
+// removes up to maxCount of the oldest values from the locked buffer in two
+// moves, like isr.c's lockedAdcBufferRemoveBlock
+static uint32_t stressTestLockedRemoveBlock(uint32_t destination[],
+                                            uint32_t maxCount) {
+  pthread_mutex_lock(&stressTestLock);
+  uint32_t indexOut = stressTestLockedBuffer.indexOut;
+  uint32_t count = stressTestLockedBuffer.elementCount;
+  // case there are fewer values than asked for
+  if (count > maxCount) {
+    count = maxCount;
+  }
+  uint32_t firstCount = STRESS_TEST_RING_SIZE - indexOut;
+  if (firstCount > count) {
+    firstCount = count;
+  }
+  memcpy(destination, &stressTestRingData[indexOut],
+         firstCount * sizeof(uint32_t));
+  memcpy(&destination[firstCount], stressTestRingData,
+         (count - firstCount) * sizeof(uint32_t));
+  stressTestLockedBuffer.indexOut = (indexOut + count) % STRESS_TEST_RING_SIZE;
+  stressTestLockedBuffer.elementCount =
+      stressTestLockedBuffer.elementCount - count;
+  pthread_mutex_unlock(&stressTestLock);
+  return count;
+}
+
+// values the consumer received, and how many of them came out of order
+static uint32_t stressTestReceivedCount;
+static uint32_t stressTestOrderErrorCount;
+
+// adds the values 0, 1, 2, ... to the ring as fast as it can, like the ISR
+static void *stressTestProducer(void *argument) {
+  (void)argument;
+  for (uint32_t value = STRESS_TEST_COUNT_INITIAL_VALUE;
+       value < STRESS_TEST_VALUE_COUNT; value++) {
+    // case the locked run
+    if (stressTestLocked) {
+      stressTestLockedAdd(value);
+    } else {
+      adcRing_add(&stressTestRing, value);
+    }
+  }
+  __atomic_store_n(&stressTestProducerDone, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// removes blocks from the ring like the detector, and checks that the values
+// keep going up. Dropped values leave gaps, but never reorder them
+static void *stressTestConsumer(void *argument) {
+  (void)argument;
+  uint32_t block[STRESS_TEST_BLOCK_SIZE];
+  uint32_t nextValue = STRESS_TEST_COUNT_INITIAL_VALUE;
+  stressTestReceivedCount = STRESS_TEST_COUNT_INITIAL_VALUE;
+  stressTestOrderErrorCount = STRESS_TEST_COUNT_INITIAL_VALUE;
+  while (true) {
+    // read before removing, so a block removed after the producer finished
+    // is always seen
+    bool producerDone =
+        __atomic_load_n(&stressTestProducerDone, __ATOMIC_ACQUIRE);
+    uint32_t count;
+    // case the locked run
+    if (stressTestLocked) {
+      count = stressTestLockedRemoveBlock(block, STRESS_TEST_BLOCK_SIZE);
+    } else {
+      count = adcRing_removeBlock(&stressTestRing, block,
+                                  STRESS_TEST_BLOCK_SIZE);
+    }
+    for (uint32_t i = STRESS_TEST_COUNT_INITIAL_VALUE; i < count; i++) {
+      // case the value came before one that was already received
+      if (block[i] < nextValue) {
+        stressTestOrderErrorCount++;
+      }
+      nextValue = block[i] + STRESS_TEST_VALUE_OFFSET;
+    }
+    stressTestReceivedCount = stressTestReceivedCount + count;
+    // case every value has been added and the ring is empty
+    if (producerDone && (count == STRESS_TEST_COUNT_INITIAL_VALUE)) {
+      return NULL;
+    }
+  }
+}
+
+// runs the producer and consumer threads on one of the buffers, prints how
+// many values per second reached the consumer and returns whether every
+// value was accounted for and in order
+static bool stressTestRun(bool locked) {
+  pthread_t producer;
+  pthread_t consumer;
+  struct timespec start;
+  struct timespec end;
+  adcRing_init(&stressTestRing, stressTestRingData, STRESS_TEST_RING_SIZE);
+  stressTestLockedBuffer.indexIn = INDEX_IN_INITIAL_VALUE;
+  stressTestLockedBuffer.indexOut = INDEX_OUT_INITIAL_VALUE;
+  stressTestLockedBuffer.elementCount = STRESS_TEST_COUNT_INITIAL_VALUE;
+  stressTestLockedBuffer.dropCount = DROP_COUNT_INITIAL_VALUE;
+  stressTestLocked = locked;
+  stressTestProducerDone = false;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_create(&consumer, NULL, stressTestConsumer, NULL);
+  pthread_create(&producer, NULL, stressTestProducer, NULL);
+  pthread_join(producer, NULL);
+  pthread_join(consumer, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (end.tv_sec - start.tv_sec) +
+                   (end.tv_nsec - start.tv_nsec) / NANOSECONDS_PER_SECOND;
+
+  uint32_t dropCount = locked ? stressTestLockedBuffer.dropCount
+                              : adcRing_getDropCount(&stressTestRing);
+  bool passed =
+      (stressTestReceivedCount + dropCount == STRESS_TEST_VALUE_COUNT) &&
+      (stressTestOrderErrorCount == STRESS_TEST_COUNT_INITIAL_VALUE);
+  // only the values that reached the consumer count towards the rate, so a
+  // buffer that drops most of them does not look fast
+  printf("%s %.1f million values/s delivered, %u received, %u dropped, "
+         "%u out of order, %s\n",
+         locked ? "locked:   " : "lock-free:",
+         stressTestReceivedCount / seconds / VALUES_PER_MILLION,
+         stressTestReceivedCount, dropCount, stressTestOrderErrorCount,
+         passed ? "passed" : "FAILED");
+  return passed;
+}
+
+// Runs a producer thread and a consumer thread through a copy of the locked
+// buffer and through a ring, prints the results and returns whether both
+// runs passed.
+bool adcRing_runStressTest() {
+  bool lockedPassed = stressTestRun(true);
+  bool lockFreePassed = stressTestRun(false);
+  return lockedPassed && lockFreePassed;
+}
+
+// the standalone host program, which fails when the stress test does
+int main() { return adcRing_runStressTest() ? EXIT_SUCCESS : EXIT_FAILURE; }
+#endif
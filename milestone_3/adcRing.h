@@ -0,0 +1,68 @@
+#ifndef ADCRING_H_
+#define ADCRING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lock-free single producer, single consumer ring of ADC values. The ISR is
+// the only producer and the detector the only consumer, so the detector never
+// has to disable interrupts to use it. Each index has one writer, which
+// stores it with release ordering after the data it covers, and the other
+// side loads it with acquire ordering. The ring is empty when the indices are
+// equal and full when indexIn is one slot behind indexOut; when it is full
+// the producer drops the new value and counts it instead of taking the oldest
+// one from the consumer's side.
+//
+// The module includes no board headers, so it also builds on a host (see
+// adcRing_runStressTest).
+
+// the indices are kept on separate cache lines so the two sides do not keep
+// taking the same line away from each other. 64 bytes covers both the board
+// (32) and desktop CPUs
+#define ADC_RING_CACHE_LINE_SIZE 64
+
+typedef struct {
+  // storage and number of slots, set by adcRing_init and only read after
+  uint32_t *data;
+  uint32_t size;
+  // written only by the producer
+  uint32_t indexIn __attribute__((aligned(ADC_RING_CACHE_LINE_SIZE)));
+  uint32_t dropCount; // values dropped because the ring was full
+  // written only by the consumer
+  uint32_t indexOut __attribute__((aligned(ADC_RING_CACHE_LINE_SIZE)));
+} adcRing_t;
+
+// Empties the ring and makes it use the size slots of data, which the caller
+// allocates (aligned to ADC_RING_CACHE_LINE_SIZE for the best speed). The
+// ring holds at most size - 1 values.
+void adcRing_init(adcRing_t *ring, uint32_t data[], uint32_t size);
+
+// Adds a value, or drops and counts it if the ring is full. Only the
+// producer may call this.
+void adcRing_add(adcRing_t *ring, uint32_t value);
+
+// Removes up to maxCount of the oldest values into destination, oldest first,
+// and returns how many were removed. The values are copied in at most two
+// moves, one on each side of the wraparound. Only the consumer may call this.
+uint32_t adcRing_removeBlock(adcRing_t *ring, uint32_t destination[],
+                             uint32_t maxCount);
+
+// Returns the number of values in the ring.
+uint32_t adcRing_elementCount(adcRing_t *ring);
+
+// Returns how many values the producer dropped because the ring was full.
+uint32_t adcRing_getDropCount(adcRing_t *ring);
+
+#ifdef ADC_RING_STRESS_TEST
+// Runs a producer thread and a consumer thread through a host copy of isr.c's
+// locked buffer (a mutex in place of disabling interrupts, the oldest value
+// overwritten when full) and then through a ring. Checks that the values
+// arrive in order and that received plus dropped values add up, prints how
+// many values per second reached the consumer and how many were dropped, and
+// returns whether both runs passed. Host only. With ADC_RING_STRESS_TEST
+// defined adcRing.c also has a main that runs it and fails when it does:
+//   gcc -std=gnu11 -O2 -Wall -Wextra -DADC_RING_STRESS_TEST -pthread adcRing.c
+bool adcRing_runStressTest();
+#endif
+
+#endif /* ADCRING_H_ */
@@ -1,14 +1,62 @@
 #include "detector.h"
+#include "detectorModes.h"
 #include "filter.h"
+#include "filterModes.h"
+#include "fixedPointFilter.h"
+#include "floatFilter.h"
 #include "hitLedTimer.h"
+#include "inputSampler.h"
 #include "interrupts.h"
+#include "isrModes.h"
+#include "intervalTimer.h"
 #include "lockoutTimer.h"
-#include "switches.h"
+#include "testSignal.h"
 
 #include <stdio.h>
 
-#define DECIMATION_COUNTER_INITIAL_VALUE 0
-#define DECIMATION_COUNTER_MAX 9
+// number of adc values handed to the decimating FIR filter at once
+#define ADC_BLOCK_SIZE 100
+#define DECIMATED_BLOCK_SIZE FILTER_MAX_DECIMATED_OUTPUTS(ADC_BLOCK_SIZE)
+
+// decimator in front of the IIR filters. FILTER_FRONT_END_CIC is the
+// cheapest when ADC throughput is the limit, at the cost of selectivity
+#define DETECTOR_FRONT_END FILTER_FRONT_END_FIR
+
+// implementation of the IIR filters. FILTER_IIR_SOS_FLOAT runs them as float
+// biquads, FILTER_IIR_INTERLEAVED runs all channels in vector lanes,
+// FILTER_IIR_PARALLEL runs every filter as independent summed sections and
+// FILTER_IIR_GENERATED runs the unrolled kernel generated from coef.h
+#define DETECTOR_IIR_ENGINE FILTER_IIR_DIRECT_FORM
+
+// what the power at each player frequency is measured with.
+// FILTER_POWER_GOERTZEL replaces the IIR filters with Goertzel blocks,
+// FILTER_POWER_SLIDING_DFT with sliding DFT bins, FILTER_POWER_CHANNELIZER
+// with an FFT filter bank and FILTER_POWER_IQ with I/Q mixers
+#define DETECTOR_POWER_ENGINE FILTER_POWER_IIR
+
+// how the power of the IIR outputs is kept. FILTER_POWER_WINDOW_BLOCKS keeps
+// 100-output block sums instead of the last 2000 outputs of every filter,
+// FILTER_POWER_WINDOW_EXPONENTIAL an exponential average with the time
+// constant below, in decimated samples, and FILTER_POWER_WINDOW_EXACT_INTEGER
+// the exact window as a sum of integer squares that never drifts
+#define DETECTOR_POWER_WINDOW FILTER_POWER_WINDOW_EXACT
+#define DETECTOR_POWER_TIME_CONSTANT 500.0
+
+// how the IIR filter state is kept out of the subnormal range during long
+// silences. FILTER_DENORMAL_GUARD_FLUSH flushes subnormals to zero while the
+// filters run and FILTER_DENORMAL_GUARD_OFFSET adds a tiny offset to them
+#define DETECTOR_DENORMAL_GUARD FILTER_DENORMAL_GUARD_OFF
+
+// filter chain the detector runs. DETECTOR_PIPELINE_FIXED_POINT runs the
+// integer chain in fixedPointFilter.c and DETECTOR_PIPELINE_FLOAT the float
+// chain in floatFilter.c, in which case the three settings above are unused
+#define DETECTOR_PIPELINE_DOUBLE 0
+#define DETECTOR_PIPELINE_FIXED_POINT 1
+#define DETECTOR_PIPELINE_FLOAT 2
+#define DETECTOR_PIPELINE DETECTOR_PIPELINE_DOUBLE
+
+// power floor of a chain whose powers are never rounded to 0
+#define NO_POWER_FLOOR 0.0
 
 #define MAX_VALUE_INDEX 9
 
@@ -17,13 +65,34 @@
 #define SORT_FOR_LOOP_START 1
 #define SORT_MOVING_OFFSET 1
 
+// number of comparators in the sorting network, and which line of a
+// comparator ends up with the smaller value
+#define SORTING_NETWORK_SIZE 29
+#define COMPARATOR_LOW_LINE 0
+#define COMPARATOR_HIGH_LINE 1
+#define COMPARATOR_LINE_COUNT 2
+
+// number of comparators in the network that only selects the median
+#define MEDIAN_NETWORK_SIZE 25
+
+// settings of detector_runSortBenchmark. The power sets are noise with one
+// loud channel, like the powers the detector sees during a shot
+#define SORT_BENCHMARK_SET_COUNT 1000
+#define SORT_BENCHMARK_ITERATIONS 200000
+#define SORT_BENCHMARK_TIMER INTERVAL_TIMER_TIMER_0
+#define SORT_BENCHMARK_LOUD_POWER 50000.0
+#define SORT_BENCHMARK_SHOT_SPACING 2
+
 #define MEDIAN_INDEX_VALUE 4
 
 #define HIT_ARRAY_INITIAL_VALUE 0
 
 #define NUM_FREQUENCIES 10
 
-#define SWITCHES_BIT_MASK 0xF
+// bit i of the ignored mask is set when frequency i is ignored
+#define FREQUENCY_BIT 1
+#define NO_FREQUENCIES_MASK 0
+#define ALL_FREQUENCIES_MASK ((FREQUENCY_BIT << NUM_FREQUENCIES) - FREQUENCY_BIT)
 
 // Set to 1000 for M3T3, will need to be lowered later for increased range
 #define FUDGE_FACTOR 1000
@@ -31,21 +100,54 @@
 #define RAW_ADC_SCALING 2047.5
 #define ADC_OFFSET 1
 
-#define TESTING_ELEMENTS 1
-
-// creates a length ten array of doubles to store the current
-// power values
+// creates a length ten array of doubles to store the sorted power values of
+// the last test run
 volatile double currentPowerValues[NUM_FREQUENCIES];
 
+// Waksman's network, the fewest comparators (29) that sort 10 values. Each
+// comparator leaves the smaller of its two lines on the low line
+static const uint8_t sortingNetwork[SORTING_NETWORK_SIZE]
+                                   [COMPARATOR_LINE_COUNT] = {
+    {4, 9}, {3, 8}, {2, 7}, {1, 6}, {0, 5}, {1, 4}, {6, 9}, {0, 3},
+    {5, 8}, {0, 2}, {3, 6}, {7, 9}, {0, 1}, {2, 4}, {5, 7}, {8, 9},
+    {1, 2}, {4, 6}, {7, 8}, {3, 5}, {2, 5}, {6, 8}, {1, 3}, {4, 7},
+    {2, 3}, {6, 7}, {3, 4}, {5, 6}, {4, 5}};
+
+// a network that leaves the 5th smallest of 10 values on line 4 and nothing
+// in particular on the other lines. It was found by a search over
+// comparator networks checked with every input of three distinct values,
+// then cut down to the comparators that reach line 4. Pruning Waksman's
+// network the same way keeps all 29
+static const uint8_t medianNetwork[MEDIAN_NETWORK_SIZE]
+                                  [COMPARATOR_LINE_COUNT] = {
+    {7, 9}, {1, 8}, {2, 6}, {0, 3}, {4, 5}, {1, 2}, {6, 8}, {2, 6}, {0, 7},
+    {3, 9}, {3, 7}, {2, 5}, {1, 4}, {4, 6}, {5, 8}, {2, 4}, {5, 6}, {6, 9},
+    {5, 7}, {3, 4}, {0, 2}, {2, 6}, {4, 5}, {1, 4}, {2, 4}};
+
+// power sets timed by detector_runSortBenchmark
+static double sortBenchmarkSets[SORT_BENCHMARK_SET_COUNT][NUM_FREQUENCIES];
+
 // constant array used to store the temporary power values used for testing
 // change 5999 to 6001 to show when a hit is actually detected
 volatile const static double tempPowerValues[NUM_FREQUENCIES] = {
     10, 1, 6001, 8, 26, 6, 17, 4, 3, 1};
 
-// frequencies are specified as true if ignores
-volatile bool detectorIgnoredFrequencies[NUM_FREQUENCIES];
+// frequencies are ignored if their bit is set. Built from the switches
+volatile uint16_t detectorIgnoredMask;
+
+// set by detector_ignoreAllHits. While it is set every frequency is ignored,
+// whatever detectorIgnoredMask says, so rebuilding the mask never undoes it
+volatile static bool detectorIgnoringAllHits;
+
+// generation of the input snapshot the ignored mask was last built from. The
+// mask is only built again when the switches may have changed
+static uint16_t ignoredMaskGeneration;
+static bool ignoredMaskBuilt;
 
-volatile uint16_t decimationCounter;
+// smallest power the selected chain can tell apart from 0. The median is
+// never taken as less than this, so a median that rounded to 0 cannot make
+// every nonzero channel a hit
+static double detectorPowerFloor;
 
 volatile uint16_t detector_hitArray[NUM_FREQUENCIES];
 
@@ -58,14 +160,9 @@ volatile static bool detector_hitDetectedFlag;
 
 // macro used to test our function in isolated mode
 volatile static bool runTest;
-// resets Decimation Counter to zero
-void resetDecimationCounter();
-
-// increments decimation counter by 1
-void incrementDecimationCounter();
-
-// returns whether decimation counter is complete
-bool decimationCounterComplete();
+// sorts the current power values and checks them for a hit, unless the
+// lockout timer is running
+static void detectorCheckForHit();
 
 //helper function that returns the current frequency based on the switches
 uint16_t detectorGetCurrentFrequency();
@@ -73,21 +170,75 @@ uint16_t detectorGetCurrentFrequency();
 //updates the ignored frequency to be the current setting of the switches
 void updateIgnoredFrequency();
 
+// runs one block of raw adc values through the double filter chain, checking
+// for a hit after every decimated value
+static void detectorRunDoublePipeline(const uint32_t rawADCValues[],
+                                      uint32_t blockCount);
+
+// same as detectorRunDoublePipeline, but with the fixed point filter chain
+static void detectorRunFixedPointPipeline(const uint32_t rawADCValues[],
+                                          uint32_t blockCount);
+
+// same as detectorRunDoublePipeline, but with the float filter chain
+static void detectorRunFloatPipeline(const uint32_t rawADCValues[],
+                                     uint32_t blockCount);
+
+// returns the current power of a channel from whichever chain is running
+static double detectorGetPowerValue(uint16_t channel);
+
+// sorts values in ascending order with the exchange sort the detector used to
+// run on every tick, moving indices along with them
+static void detectorExchangeSort(double values[], uint16_t indices[]);
+
+// puts the smaller of values[low] and values[high] on line low and the larger
+// on line high, moving indices along with them, without branching
+static void detectorCompareExchange(double values[], uint16_t indices[],
+                                    uint8_t low, uint8_t high);
+
+// returns the largest of the 10 values, the channel it came from and the
+// median (the 5th smallest), without branching on the values
+static void detectorSelectMaxAndMedian(const double values[],
+                                       double *maxValue, uint16_t *maxChannel,
+                                       double *medianValue);
+
 // Always have to init things.
 // bool array is indexed by frequency number, array location set for true to
 // ignore, false otherwise. This way you can ignore multiple frequencies.
 void detector_init(bool ignoredFrequencies[]) {
-  filter_init();
+  // case the integer filter chain was selected, so only it is set up
+  if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FIXED_POINT) {
+    fixedPointFilter_init();
+    detectorPowerFloor = fixedPointFilter_getPowerResolution();
+  }
+  // case the float filter chain was selected
+  else if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FLOAT) {
+    floatFilter_init();
+    detectorPowerFloor = NO_POWER_FLOOR;
+  } else {
+    filter_setIirEngine(DETECTOR_IIR_ENGINE);
+    filter_setPowerWindow(DETECTOR_POWER_WINDOW);
+    filter_setPowerTimeConstant(DETECTOR_POWER_TIME_CONSTANT);
+    filter_setDenormalGuard(DETECTOR_DENORMAL_GUARD);
+    filter_setPowerEngine(DETECTOR_POWER_ENGINE);
+    filter_initWithFrontEnd(DETECTOR_FRONT_END);
+    detectorPowerFloor = filter_getPowerResolution();
+  }
   // may need to call lockoutTimer_init and hitLedTimer_init here. But I don't
-  // think so resets DecimationCounter to zero
-  resetDecimationCounter();
+  // think so
 
   // iterates through each value in the frequencies to ignore specific
   // frequencies also sets the detector_hitArray to all zeros
+  detectorIgnoredMask = NO_FREQUENCIES_MASK;
   for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
-    detectorIgnoredFrequencies[i] = ignoredFrequencies[i];
+    // case this frequency is ignored, so its bit is set
+    if (ignoredFrequencies[i]) {
+      detectorIgnoredMask = detectorIgnoredMask | (FREQUENCY_BIT << i);
+    }
     detector_hitArray[i] = HIT_ARRAY_INITIAL_VALUE;
   }
+  // the switches take over on the first hit check, as before
+  ignoredMaskBuilt = false;
+  detectorIgnoringAllHits = false;
   detector_hitDetectedFlag = false;
   channelHitInitialized = false;
   // sets runTest to false
@@ -105,168 +256,211 @@ void detector_init(bool ignoredFrequencies[]) {
 // if ignoreSelf == true, ignore hits that are detected on your frequency.
 // Your frequency is simply the frequency indicated by the slide switches
 void detector(bool interruptsCurrentlyEnabled) {
-  // helper variable used to store the raw adc value which is between 0 and 4095
-  uint32_t rawADCValue;
   // helper variable that stores the number of elements in the buffer
   uint32_t elementCount = isr_adcBufferElementCount();
-  // helper variable that stores the scaled ADC value
-  double scaledADCValue;
+  // block of raw adc values, each between 0 and 4095, that are handed to the
+  // decimating FIR filter together
+  uint32_t rawADCValues[ADC_BLOCK_SIZE];
 
-  // case run test is true, we change the number of
-  // elements to just be one, so we only iterate through the
-  // proceeding for loop once
+  // case run test is true, we skip the filters and run the hit detection
+  // once on the test power values
   if (runTest) {
-    elementCount = TESTING_ELEMENTS;
+    detectorCheckForHit();
+    return;
   }
 
-  // as per the instructions, we do the following steps the same number of times
-  // as there are elements left in the ADC queue
-  for (uint32_t i = FOR_LOOP_START_VALUE; i < elementCount; i++) {
-    // case the ARM interrupts are currently enabled, in which case, we disable
-    // them before proceeding to pop the oldest data value from the queue and
-    // storing it in the variable rawADCValue. Then we re-enable the interrupts
-    if (interruptsCurrentlyEnabled) {
+  // as per the instructions, we process as many values as there are elements
+  // left in the ADC queue, one block at a time
+  while (elementCount > FOR_LOOP_START_VALUE) {
+    uint32_t blockCount = elementCount;
+    // case there are more elements than fit in a block
+    if (blockCount > ADC_BLOCK_SIZE) {
+      blockCount = ADC_BLOCK_SIZE;
+    }
+
+    // case the ARM interrupts are currently enabled, in which case, we
+    // disable them once for the whole block, copy the oldest values out of
+    // the queue and re-enable them before running the filters. The lock-free
+    // ring needs no critical section at all
+    if (interruptsCurrentlyEnabled && !isr_adcBufferIsLockFree()) {
       interrupts_disableArmInts();
-      rawADCValue = isr_removeDataFromAdcBuffer();
+      blockCount = isr_removeBlockFromAdcBuffer(rawADCValues, blockCount);
       interrupts_enableArmInts();
     }
-    // otherwise, if the interrupts are not enabled, we just pop it and continue
+    // otherwise, if the interrupts are not enabled, we just copy them out
     else {
-      rawADCValue = isr_removeDataFromAdcBuffer();
+      blockCount = isr_removeBlockFromAdcBuffer(rawADCValues, blockCount);
+    }
+    // case the queue was emptied while we were not looking
+    if (blockCount == FOR_LOOP_START_VALUE) {
+      break;
     }
 
-    // scales the RAW ADC value by dividing it by 2047.5 and then subtracting 1
-    // so we end up with values between -1 and 1
-    scaledADCValue = (rawADCValue / RAW_ADC_SCALING) - ADC_OFFSET;
-
-    // we add the newly calculated scaledADCValue to the filter queue
-    filter_addNewInput(scaledADCValue);
-
-    // case the decimation counter is complete, and we do all the other code
-    // and call all the filter functions. at the end, we reset the counter
-    // or if we are also running the test it will run
-    if (decimationCounterComplete() || runTest) {
-
-      // case we are not running a test and we do do all the stuff with
-      // the filters
-      if (!runTest) {
-        // runs the FIR filter
-        filter_firFilter();
-
-        // iterates through and runs each of the IIR Filters
-        for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
-          filter_iirFilter(j);
-        }
-
-        // iterates through and runs each of the compute power functions
-        for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
-          filter_computePower(j, false, false);
-        }
-      }
+    // case the integer filter chain was selected
+    if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FIXED_POINT) {
+      detectorRunFixedPointPipeline(rawADCValues, blockCount);
+    }
+    // case the float filter chain was selected
+    else if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FLOAT) {
+      detectorRunFloatPipeline(rawADCValues, blockCount);
+    } else {
+      detectorRunDoublePipeline(rawADCValues, blockCount);
+    }
+
+    elementCount = elementCount - blockCount;
+  }
+}
+
+// runs one block of raw adc values through the double filter chain, checking
+// for a hit after every decimated value
+static void detectorRunDoublePipeline(const uint32_t rawADCValues[],
+                                      uint32_t blockCount) {
+  // decimated FIR outputs produced from one block of raw adc values
+  double decimatedValues[DECIMATED_BLOCK_SIZE];
+
+  // scales the block and runs it through the decimating FIR filter, which
+  // only returns an output for every tenth value
+  uint32_t decimatedCount =
+      filter_decimateAdcBlock(rawADCValues, blockCount, decimatedValues);
+
+  // runs the rest of the detector once for each decimated value
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < decimatedCount; i++) {
+    filter_addNewFirOutput(decimatedValues[i]);
+
+    // runs all of the IIR Filters, sharing the b*y sum between them
+    filter_iirFilterBank();
+
+    // updates the power of every filter at once
+    filter_computePowerBank(false);
+
+    detectorCheckForHit();
+  }
+}
+
+// same as detectorRunDoublePipeline, but with the fixed point filter chain
+static void detectorRunFixedPointPipeline(const uint32_t rawADCValues[],
+                                          uint32_t blockCount) {
+  int32_t decimatedValues[DECIMATED_BLOCK_SIZE];
+  uint32_t decimatedCount = fixedPointFilter_decimateAdcBlock(
+      rawADCValues, blockCount, decimatedValues);
+
+  // the IIR filters also update the powers, so only the hit check is left
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < decimatedCount; i++) {
+    fixedPointFilter_filterBank(decimatedValues[i]);
+    detectorCheckForHit();
+  }
+}
 
-      // case the lockoutTimer is not running, so we look for another hit
-      if (!lockoutTimer_running()) {
-
-        // creates an array that will correspond to the indecies of the sorted
-        // current power values array
-        uint16_t channelIndexArray[NUM_FREQUENCIES];
-        // case we are running a test and we initialize all the values to the
-        // following
-        if (runTest) {
-          // initializes the values for all of the channel index array values
-          // and the current power Values to be the temp test array
-          for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
-            currentPowerValues[j] = tempPowerValues[j];
-            channelIndexArray[j] = j;
-          }
-        }
-        // case we are not running a test and we do all the normal stuff
-        // of getting the currentPowerValues and initializing the
-        // channelIndexArray
-        else {
-          // iterates through for each filter and stores the power values in the
-          // current power values array. Also populates the channel index array
-          // with all the player numbers
-          for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
-            currentPowerValues[j] = filter_getCurrentPowerValue(j);
-            channelIndexArray[j] = j;
-          }
-        }
-
-        // insertion sort Algorithm
-
-        // does the inside loop 10 times for each of the possible elements
-        for (uint16_t j = SORT_FOR_LOOP_START; j < NUM_FREQUENCIES; j++) {
-          // moves a single value to its correct relative position
-          for (uint16_t k = SORT_FOR_LOOP_START; k < NUM_FREQUENCIES; k++) {
-            // case the value at k is less than the value at k-1. so, we switch
-            // them
-            if (currentPowerValues[k - SORT_MOVING_OFFSET] >
-                currentPowerValues[k]) {
-              // this block of code will move the value that was at k - 1 to the
-              // k index and move the one that was at the k index to the k - 1
-              // index, if the above condition is true
-              double temp = currentPowerValues[k];
-              currentPowerValues[k] =
-                  currentPowerValues[k - SORT_MOVING_OFFSET];
-              currentPowerValues[k - SORT_MOVING_OFFSET] = temp;
-
-              // mirrors the above block by also sorting the index array
-              // accordingly so we can keep track of who is who
-              uint16_t tempInt = channelIndexArray[k];
-              channelIndexArray[k] = channelIndexArray[k - SORT_MOVING_OFFSET];
-              channelIndexArray[k - SORT_MOVING_OFFSET] = tempInt;
-            }
-          }
-        }
-
-        // median value is now the 5th element (index 4) of the
-        // currentPowerValues array
-        double medianValue = currentPowerValues[MEDIAN_INDEX_VALUE];
-
-        // multiply the medianValue by the Fudge Factor to get the threshold
-        // value
-        double thresholdValue = medianValue * FUDGE_FACTOR;
-
-        // the maxValue is the last element of the current Power Values array,
-        // which is currentPowerValues[9]
-        double maxValue = currentPowerValues[MAX_VALUE_INDEX];
-
-
-        //updates the ignored frequency so it does not register itself
-        updateIgnoredFrequency();
-        // compares to see if the maxValue is greater than the threshold value.
-        // If true then we set the flags to true, start the lockout and led
-        // timers
-        if ((maxValue > thresholdValue) && (!detectorIgnoredFrequencies[channelIndexArray[MAX_VALUE_INDEX]])) {
-
-
-          // sets the lastChannelHit variable to the index of the highest power
-          // channel
-          lastChannelHit = channelIndexArray[MAX_VALUE_INDEX];
-          // increments the number of hits, for that specified channel, by 1
-          (detector_hitArray[lastChannelHit])++;
-          // starts lockout timer so that we don't do any more checking for a
-          // hit for the next 2000 milliseconds
-          lockoutTimer_start();
-          // starts the timer for the hit led, which will illiminate the led
-          hitLedTimer_start();
-
-          // sets the hit detected flag to true
-          detector_hitDetectedFlag = true;
-        }
-        // otherwise, we set the hitDetectedFlag to false
-        else {
-          detector_hitDetectedFlag = false;
-        }
+// same as detectorRunDoublePipeline, but with the float filter chain
+static void detectorRunFloatPipeline(const uint32_t rawADCValues[],
+                                     uint32_t blockCount) {
+  float decimatedValues[DECIMATED_BLOCK_SIZE];
+  uint32_t decimatedCount =
+      floatFilter_decimateAdcBlock(rawADCValues, blockCount, decimatedValues);
+
+  // the IIR filters also update the powers, so only the hit check is left
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < decimatedCount; i++) {
+    floatFilter_filterBank(decimatedValues[i]);
+    detectorCheckForHit();
+  }
+}
+
+// returns the current power of a channel from whichever chain is running
+static double detectorGetPowerValue(uint16_t channel) {
+  // case the integer filter chain was selected. Its powers have a different
+  // scale, but the hit check only compares them with each other
+  if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FIXED_POINT) {
+    return fixedPointFilter_getCurrentPowerValue(channel);
+  }
+  // case the float filter chain was selected
+  if (DETECTOR_PIPELINE == DETECTOR_PIPELINE_FLOAT) {
+    return floatFilter_getCurrentPowerValue(channel);
+  }
+  return filter_getCurrentPowerValue(channel);
+}
+
+// sorts the current power values and checks them for a hit, unless the
+// lockout timer is running
+static void detectorCheckForHit() {
+  // case the lockoutTimer is not running, so we look for another hit
+  if (!lockoutTimer_running()) {
+
+    // power of every channel, in channel order
+    double powerValues[NUM_FREQUENCIES];
+    double medianValue;
+    double maxValue;
+    uint16_t maxChannel;
+    // case we are running a test, so the temp test powers are fully sorted
+    // and the sorted array is kept so the test can print it
+    if (runTest) {
+      double sortedValues[NUM_FREQUENCIES];
+      uint32_t maxPowerFreqNo;
+      for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
+        powerValues[j] = tempPowerValues[j];
       }
+      detector_sort(&maxPowerFreqNo, powerValues, sortedValues);
+      for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
+        currentPowerValues[j] = sortedValues[j];
+      }
+      medianValue = sortedValues[MEDIAN_INDEX_VALUE];
+      maxValue = sortedValues[MAX_VALUE_INDEX];
+      maxChannel = maxPowerFreqNo;
+    }
+    // case we are not running a test. The hit check only needs the max and
+    // the median, so those are selected without sorting the rest
+    else {
+      for (uint16_t j = FOR_LOOP_START_VALUE; j < NUM_FREQUENCIES; j++) {
+        powerValues[j] = detectorGetPowerValue(j);
+      }
+      detectorSelectMaxAndMedian(powerValues, &maxValue, &maxChannel,
+                                 &medianValue);
+    }
 
-      resetDecimationCounter();
+    // case the median is below what the chain can resolve (an integer power
+    // whose outputs or squares all rounded to 0), so the resolution stands
+    // in for it
+    if (medianValue < detectorPowerFloor) {
+      medianValue = detectorPowerFloor;
+    }
+    // multiply the medianValue by the Fudge Factor to get the threshold
+    // value
+    double thresholdValue = medianValue * FUDGE_FACTOR;
+
+
+    // updates the ignored frequency so it does not register itself, but
+    // only if the inputs changed since the mask was last built
+    uint16_t inputGeneration =
+        inputSampler_getGeneration(inputSampler_getSnapshot());
+    if (!ignoredMaskBuilt || (inputGeneration != ignoredMaskGeneration)) {
+      updateIgnoredFrequency();
+      ignoredMaskGeneration = inputGeneration;
+      ignoredMaskBuilt = true;
     }
-    // case the decimation counter is not complete, and we just increment the
-    // counter
+    uint16_t ignoredMask =
+        detectorIgnoringAllHits ? ALL_FREQUENCIES_MASK : detectorIgnoredMask;
+    // compares to see if the maxValue is greater than the threshold value.
+    // If true then we set the flags to true, start the lockout and led
+    // timers
+    if ((maxValue > thresholdValue) && (!(ignoredMask & (FREQUENCY_BIT << maxChannel)))) {
+
+
+      // sets the lastChannelHit variable to the index of the highest power
+      // channel
+      lastChannelHit = maxChannel;
+      // increments the number of hits, for that specified channel, by 1
+      (detector_hitArray[lastChannelHit])++;
+      // starts lockout timer so that we don't do any more checking for a
+      // hit for the next 2000 milliseconds
+      lockoutTimer_start();
+      // starts the timer for the hit led, which will illiminate the led
+      hitLedTimer_start();
+
+      // sets the hit detected flag to true
+      detector_hitDetectedFlag = true;
+    }
+    // otherwise, we set the hitDetectedFlag to false
     else {
-      incrementDecimationCounter();
+      detector_hitDetectedFlag = false;
     }
   }
 }
@@ -290,36 +484,10 @@ void detector_clearHit() { detector_hitDetectedFlag = false; }
 // respond to hits normally.
 void detector_ignoreAllHits(bool flagValue) 
 {
-  //helper function used to ignore all frequencies
-  
-  //case ignoreAllHits flag value is true and we ignore all frequencies hits
-  if(flagValue)
-  {
-    //we iterate through the entire detector Ignored Frequencies array to
-    //ignore all frequencies
-    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++)
-    {
-      detectorIgnoredFrequencies[i] = true;
-    }
-  }
-  //case we don't ignore all frequencies. We reset all to false except the 
-  //current frequency
-  else
-  {
-    for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++)
-    {
-      //case we are not at the current frequency
-      if(i != detectorGetCurrentFrequency())
-      {
-        detectorIgnoredFrequencies[i] = false;
-      }
-      //case we are at the current frequency and we set that to true
-      else
-      {
-        detectorIgnoredFrequencies[i] = true;
-      }
-    }
-  }
+  //the flag is kept apart from the mask the switches build, so it holds
+  //until it is cleared, and clearing it brings back the current switch
+  //frequency
+  detectorIgnoringAllHits = flagValue;
 }
 
 // Get the current hit counts.
@@ -348,7 +516,201 @@ void detector_setFudgeFactorIndex(uint32_t temp) {}
 // array arguments is 10.
 detector_status_t detector_sort(uint32_t *maxPowerFreqNo,
                                 double unsortedValues[],
-                                double sortedValues[]) {}
+                                double sortedValues[]) {
+  // channel each sorted value came from
+  uint16_t channelIndexArray[NUM_FREQUENCIES];
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+    sortedValues[i] = unsortedValues[i];
+    channelIndexArray[i] = i;
+  }
+  // the comparators are the same whatever the values are, so the sort always
+  // takes the same time
+  for (uint16_t c = FOR_LOOP_START_VALUE; c < SORTING_NETWORK_SIZE; c++) {
+    detectorCompareExchange(sortedValues, channelIndexArray,
+                            sortingNetwork[c][COMPARATOR_LOW_LINE],
+                            sortingNetwork[c][COMPARATOR_HIGH_LINE]);
+  }
+  *maxPowerFreqNo = channelIndexArray[MAX_VALUE_INDEX];
+  return DETECTOR_STATUS_OK;
+}
+
+// sorts values in ascending order with the exchange sort the detector used to
+// run on every tick, moving indices along with them
+static void detectorExchangeSort(double values[], uint16_t indices[]) {
+  // does the inside loop 10 times for each of the possible elements
+  for (uint16_t j = SORT_FOR_LOOP_START; j < NUM_FREQUENCIES; j++) {
+    // moves a single value to its correct relative position
+    for (uint16_t k = SORT_FOR_LOOP_START; k < NUM_FREQUENCIES; k++) {
+      // case the value at k is less than the value at k-1. so, we switch them
+      if (values[k - SORT_MOVING_OFFSET] > values[k]) {
+        double temp = values[k];
+        values[k] = values[k - SORT_MOVING_OFFSET];
+        values[k - SORT_MOVING_OFFSET] = temp;
+
+        // mirrors the above block by also sorting the index array
+        // accordingly so we can keep track of who is who
+        uint16_t tempInt = indices[k];
+        indices[k] = indices[k - SORT_MOVING_OFFSET];
+        indices[k - SORT_MOVING_OFFSET] = tempInt;
+      }
+    }
+  }
+}
+
+// puts the smaller of values[low] and values[high] on line low and the larger
+// on line high, moving indices along with them, without branching
+static void detectorCompareExchange(double values[], uint16_t indices[],
+                                    uint8_t low, uint8_t high) {
+  double lowValue = values[low];
+  double highValue = values[high];
+  // the value selects compile to min and max instructions (or conditional
+  // moves), and the indices are swapped through a mask of all ones when the
+  // pair is out of order
+  uint16_t swapMask = -(uint16_t)(lowValue > highValue);
+  uint16_t indexDifference = (indices[low] ^ indices[high]) & swapMask;
+  double smaller = (lowValue < highValue) ? lowValue : highValue;
+  double larger = (highValue < lowValue) ? lowValue : highValue;
+  values[low] = smaller;
+  values[high] = larger;
+  indices[low] = indices[low] ^ indexDifference;
+  indices[high] = indices[high] ^ indexDifference;
+}
+
+// returns the largest of the 10 values, the channel it came from and the
+// median (the 5th smallest), without branching on the values
+static void detectorSelectMaxAndMedian(const double values[],
+                                       double *maxValue, uint16_t *maxChannel,
+                                       double *medianValue) {
+  double lines[NUM_FREQUENCIES];
+  for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+    lines[i] = values[i];
+  }
+  // the median network needs 25 comparators instead of the 29 of a sort, and
+  // without the indices each one is just a min and a max
+  for (uint16_t c = FOR_LOOP_START_VALUE; c < MEDIAN_NETWORK_SIZE; c++) {
+    uint8_t low = medianNetwork[c][COMPARATOR_LOW_LINE];
+    uint8_t high = medianNetwork[c][COMPARATOR_HIGH_LINE];
+    double lowValue = lines[low];
+    double highValue = lines[high];
+    double smaller = (lowValue < highValue) ? lowValue : highValue;
+    double larger = (highValue < lowValue) ? lowValue : highValue;
+    lines[low] = smaller;
+    lines[high] = larger;
+  }
+  *medianValue = lines[MEDIAN_INDEX_VALUE];
+
+  // the max and its channel take 9 more compares. On a tie the last channel
+  // wins, same as with the exchange sort
+  double max = values[FOR_LOOP_START_VALUE];
+  uint16_t channel = FOR_LOOP_START_VALUE;
+  for (uint16_t i = SORT_FOR_LOOP_START; i < NUM_FREQUENCIES; i++) {
+    uint16_t takeMask = -(uint16_t)(values[i] >= max);
+    max = (values[i] >= max) ? values[i] : max;
+    channel = channel ^ ((channel ^ i) & takeMask);
+  }
+  *maxValue = max;
+  *maxChannel = channel;
+}
+
+// Times the exchange sort, detector_sort and the max and median selection on
+// the same power sets and checks that they agree.
+void detector_runSortBenchmark() {
+  uint32_t noiseState = TEST_SIGNAL_NOISE_SEED;
+  double sortedValues[NUM_FREQUENCIES];
+  uint16_t channelIndexArray[NUM_FREQUENCIES];
+  uint32_t maxPowerFreqNo;
+  double maxValue;
+  double medianValue;
+  uint16_t maxChannel;
+  // sum of the medians, printed so none of the kernels can be optimized away
+  double medianSum = 0.0;
+  uint32_t mismatchCount = FOR_LOOP_START_VALUE;
+  double exchangeSeconds;
+  double networkSeconds;
+  double selectionSeconds;
+
+  // every set is noise, and every other set has one loud channel
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SORT_BENCHMARK_SET_COUNT; s++) {
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+      sortBenchmarkSets[s][i] = testSignal_nextUniform(&noiseState);
+    }
+    // case this set has a shot in it
+    if (s % SORT_BENCHMARK_SHOT_SPACING == FOR_LOOP_START_VALUE) {
+      sortBenchmarkSets[s][(s / SORT_BENCHMARK_SHOT_SPACING) % NUM_FREQUENCIES] =
+          SORT_BENCHMARK_LOUD_POWER;
+    }
+  }
+
+  // checks every set once before timing anything
+  for (uint16_t s = FOR_LOOP_START_VALUE; s < SORT_BENCHMARK_SET_COUNT; s++) {
+    double exchangeValues[NUM_FREQUENCIES];
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+      exchangeValues[i] = sortBenchmarkSets[s][i];
+      channelIndexArray[i] = i;
+    }
+    detectorExchangeSort(exchangeValues, channelIndexArray);
+    detector_sort(&maxPowerFreqNo, sortBenchmarkSets[s], sortedValues);
+    detectorSelectMaxAndMedian(sortBenchmarkSets[s], &maxValue, &maxChannel,
+                               &medianValue);
+    bool sortsAgree = true;
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+      sortsAgree = sortsAgree && (exchangeValues[i] == sortedValues[i]);
+    }
+    // case any of the kernels disagrees with the exchange sort
+    if (!sortsAgree ||
+        (maxPowerFreqNo != channelIndexArray[MAX_VALUE_INDEX]) ||
+        (maxValue != exchangeValues[MAX_VALUE_INDEX]) ||
+        (maxChannel != channelIndexArray[MAX_VALUE_INDEX]) ||
+        (medianValue != exchangeValues[MEDIAN_INDEX_VALUE])) {
+      mismatchCount++;
+    }
+  }
+
+  intervalTimer_init(SORT_BENCHMARK_TIMER);
+  intervalTimer_start(SORT_BENCHMARK_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < SORT_BENCHMARK_ITERATIONS; n++) {
+    const double *set = sortBenchmarkSets[n % SORT_BENCHMARK_SET_COUNT];
+    for (uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++) {
+      sortedValues[i] = set[i];
+      channelIndexArray[i] = i;
+    }
+    detectorExchangeSort(sortedValues, channelIndexArray);
+    medianSum = medianSum + sortedValues[MEDIAN_INDEX_VALUE];
+  }
+  intervalTimer_stop(SORT_BENCHMARK_TIMER);
+  exchangeSeconds = intervalTimer_getTotalDurationInSeconds(SORT_BENCHMARK_TIMER) / SORT_BENCHMARK_ITERATIONS;
+
+  intervalTimer_reset(SORT_BENCHMARK_TIMER);
+  intervalTimer_start(SORT_BENCHMARK_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < SORT_BENCHMARK_ITERATIONS; n++) {
+    detector_sort(&maxPowerFreqNo,
+                  sortBenchmarkSets[n % SORT_BENCHMARK_SET_COUNT],
+                  sortedValues);
+    medianSum = medianSum + sortedValues[MEDIAN_INDEX_VALUE];
+  }
+  intervalTimer_stop(SORT_BENCHMARK_TIMER);
+  networkSeconds = intervalTimer_getTotalDurationInSeconds(SORT_BENCHMARK_TIMER) / SORT_BENCHMARK_ITERATIONS;
+
+  intervalTimer_reset(SORT_BENCHMARK_TIMER);
+  intervalTimer_start(SORT_BENCHMARK_TIMER);
+  for (uint32_t n = FOR_LOOP_START_VALUE; n < SORT_BENCHMARK_ITERATIONS; n++) {
+    detectorSelectMaxAndMedian(sortBenchmarkSets[n % SORT_BENCHMARK_SET_COUNT],
+                               &maxValue, &maxChannel, &medianValue);
+    medianSum = medianSum + medianValue;
+  }
+  intervalTimer_stop(SORT_BENCHMARK_TIMER);
+  selectionSeconds = intervalTimer_getTotalDurationInSeconds(SORT_BENCHMARK_TIMER) / SORT_BENCHMARK_ITERATIONS;
+
+  printf("exchange sort:            %e seconds (%.0f cycles)\n",
+         exchangeSeconds, exchangeSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  printf("detector_sort network:    %e seconds (%.0f cycles)\n",
+         networkSeconds, networkSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  printf("max and median selection: %e seconds (%.0f cycles)\n",
+         selectionSeconds, selectionSeconds * FILTER_BENCHMARK_CPU_CLOCK_HZ);
+  printf("sets that disagree with the exchange sort: %u of %d (median sum "
+         "%f)\n",
+         mismatchCount, SORT_BENCHMARK_SET_COUNT, medianSum);
+}
 
 // Encapsulate ADC scaling for easier testing.
 double detector_getScaledAdcValue(isr_AdcValue_t adcValue) {}
@@ -403,23 +765,11 @@ void detector_runTest() {
   printf("\n");
 }
 
-// resets Decimation Counter to zero
-void resetDecimationCounter() {
-  decimationCounter = DECIMATION_COUNTER_INITIAL_VALUE;
-}
-
-// increments decimation counter by 1
-void incrementDecimationCounter() { decimationCounter++; }
-
-// returns whether decimation counter is complete
-bool decimationCounterComplete() {
-  return (decimationCounter >= DECIMATION_COUNTER_MAX);
-}
-
 //helper function that returns the current frequency based on the switches
 uint16_t detectorGetCurrentFrequency()
 {
-  uint16_t switchSetting = switches_read() & SWITCHES_BIT_MASK; // Bit-mask the results.
+  // the switches come from the latest input snapshot rather than the device
+  uint16_t switchSetting = inputSampler_getSwitches(inputSampler_getSnapshot());
   // Provide a nice default if the slide switches are in error.
   if (!(switchSetting < NUM_FREQUENCIES))
   {
@@ -437,17 +787,5 @@ uint16_t detectorGetCurrentFrequency()
 void updateIgnoredFrequency()
 {
   //sets all ignored frequencies to false except the current switches value
-  for(uint16_t i = FOR_LOOP_START_VALUE; i < NUM_FREQUENCIES; i++)
-  {
-    //case i is not equal to current frequency setting
-    if(i != detectorGetCurrentFrequency())
-    {
-      detectorIgnoredFrequencies[i] = false;
-    }
-    //but if it is,  we set it to true, or ignored
-    else
-    {
-      detectorIgnoredFrequencies[i] = true;
-    }
-  }
+  detectorIgnoredMask = FREQUENCY_BIT << detectorGetCurrentFrequency();
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "inputSampler.h"
+#include "buttons.h"
+#include "mio.h"
+#include "switches.h"
+
+// layout of a snapshot. The inputs take the lower half and the generation the
+// upper half
+#define SWITCHES_BIT_MASK 0xF
+#define SWITCHES_SHIFT 0
+#define BUTTONS_BIT_MASK 0xF
+#define BUTTONS_SHIFT 4
+#define TRIGGER_PIN_BIT_MASK 0x1
+#define TRIGGER_PIN_SHIFT 8
+#define INPUTS_BIT_MASK 0xFFFF
+#define GENERATION_BIT_MASK 0xFFFF
+#define GENERATION_SHIFT 16
+
+#define TICK_COUNTER_INITIAL_VALUE 0
+#define GENERATION_INITIAL_VALUE 0
+#define MINIMUM_PERIOD_TICKS 1
+#define GENERATION_INCREMENT 1
+
+// latest snapshot, written only by the ISR
+volatile static uint32_t latestSnapshot;
+
+// number of ISR ticks between samples
+volatile static uint32_t periodTicks = INPUT_SAMPLER_DEFAULT_PERIOD_TICKS;
+
+// ticks since the last sample
+static uint32_t tickCounter;
+
+// reads the devices and packs them into the lower half of a snapshot
+static uint32_t inputSamplerReadInputs();
+
+// Samples the inputs once and publishes them as the first snapshot. Call it
+// after the switches, buttons and mio have been initialized.
+void inputSampler_init() {
+  tickCounter = TICK_COUNTER_INITIAL_VALUE;
+  latestSnapshot = inputSamplerReadInputs() |
+                   ((uint32_t)GENERATION_INITIAL_VALUE << GENERATION_SHIFT);
+}
+
+// Sets how many ISR ticks there are between samples.
+void inputSampler_setPeriod(uint32_t ticks) {
+  // case the period is zero, so the inputs are sampled on every tick
+  if (ticks < MINIMUM_PERIOD_TICKS) {
+    ticks = MINIMUM_PERIOD_TICKS;
+  }
+  periodTicks = ticks;
+}
+
+// Standard tick function, called from the ISR. Samples the inputs every
+// period ticks and publishes a new snapshot when any of them changed.
+void inputSampler_tick() {
+  tickCounter++;
+  // case it is not yet time for the next sample
+  if (tickCounter < periodTicks) {
+    return;
+  }
+  tickCounter = TICK_COUNTER_INITIAL_VALUE;
+
+  uint32_t inputs = inputSamplerReadInputs();
+  uint32_t previous = latestSnapshot;
+  // case an input changed, so the new inputs are published with the next
+  // generation in the same write
+  if (inputs != (previous & INPUTS_BIT_MASK)) {
+    uint32_t generation =
+        ((previous >> GENERATION_SHIFT) + GENERATION_INCREMENT) &
+        GENERATION_BIT_MASK;
+    latestSnapshot = inputs | (generation << GENERATION_SHIFT);
+  }
+}
+
+// Returns the latest snapshot.
+uint32_t inputSampler_getSnapshot() { return latestSnapshot; }
+
+// Returns the generation of a snapshot.
+uint16_t inputSampler_getGeneration(uint32_t snapshot) {
+  return (snapshot >> GENERATION_SHIFT) & GENERATION_BIT_MASK;
+}
+
+// Returns the 4 slide switch bits of a snapshot.
+uint16_t inputSampler_getSwitches(uint32_t snapshot) {
+  return (snapshot >> SWITCHES_SHIFT) & SWITCHES_BIT_MASK;
+}
+
+// Returns the push button bits of a snapshot.
+uint16_t inputSampler_getButtons(uint32_t snapshot) {
+  return (snapshot >> BUTTONS_SHIFT) & BUTTONS_BIT_MASK;
+}
+
+// Returns whether the trigger pin was pressed in a snapshot.
+bool inputSampler_getTriggerPin(uint32_t snapshot) {
+  return (snapshot >> TRIGGER_PIN_SHIFT) & TRIGGER_PIN_BIT_MASK;
+}
+
+// reads the devices and packs them into the lower half of a snapshot
+static uint32_t inputSamplerReadInputs() {
+  uint32_t switches = switches_read() & SWITCHES_BIT_MASK;
+  uint32_t buttons = buttons_read() & BUTTONS_BIT_MASK;
+  uint32_t triggerPin = (mio_readPin(INPUT_SAMPLER_TRIGGER_PIN) ==
+                         INPUT_SAMPLER_TRIGGER_PRESSED);
+  return (switches << SWITCHES_SHIFT) | (buttons << BUTTONS_SHIFT) |
+         (triggerPin << TRIGGER_PIN_SHIFT);
+}
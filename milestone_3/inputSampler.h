@@ -0,0 +1,49 @@
+#ifndef INPUTSAMPLER_H_
+#define INPUTSAMPLER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Samples the slide switches, the push buttons and the trigger pin from the
+// ISR at a low rate and publishes them as one packed 32-bit snapshot, so the
+// detector and the trigger read a variable instead of the devices on every
+// tick. The upper half of the snapshot is a generation counter that goes up
+// whenever any input changes, so a reader can tell it has to act on a change
+// by comparing generations. The whole snapshot is a single aligned word, so a
+// reader never sees the inputs of one sample with the generation of another.
+
+// number of 100 kHz ISR ticks between samples, 1 kHz by default
+#define INPUT_SAMPLER_DEFAULT_PERIOD_TICKS 100
+
+// mio pin the trigger is wired to, and the level it reads when pressed. The
+// trigger sets the pin up as an input, and the sampler reads it
+#define INPUT_SAMPLER_TRIGGER_PIN 10
+#define INPUT_SAMPLER_TRIGGER_PRESSED 1
+
+// Samples the inputs once and publishes them as the first snapshot. Call it
+// after the switches, buttons and mio have been initialized.
+void inputSampler_init();
+
+// Sets how many ISR ticks there are between samples.
+void inputSampler_setPeriod(uint32_t ticks);
+
+// Standard tick function, called from the ISR. Samples the inputs every
+// period ticks and publishes a new snapshot when any of them changed.
+void inputSampler_tick();
+
+// Returns the latest snapshot.
+uint32_t inputSampler_getSnapshot();
+
+// Returns the generation of a snapshot.
+uint16_t inputSampler_getGeneration(uint32_t snapshot);
+
+// Returns the 4 slide switch bits of a snapshot.
+uint16_t inputSampler_getSwitches(uint32_t snapshot);
+
+// Returns the push button bits of a snapshot.
+uint16_t inputSampler_getButtons(uint32_t snapshot);
+
+// Returns whether the trigger pin was pressed in a snapshot.
+bool inputSampler_getTriggerPin(uint32_t snapshot);
+
+#endif /* INPUTSAMPLER_H_ */
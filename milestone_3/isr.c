@@ -1,6 +1,9 @@
 #include "isr.h"
+#include "adcRing.h"
 #include "buttons.h"
 #include "hitLedTimer.h"
+#include "inputSampler.h"
+#include "isrModes.h"
 #include "lockoutTimer.h"
 #include "switches.h"
 #include "transmitter.h"
@@ -8,6 +11,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "detector.h"
 #include "interrupts.h"
@@ -17,9 +21,50 @@
 
 // change this back to original after testing 100000
 #define ADC_BUFFER_SIZE 100000
+
+// how the ADC buffer is shared between the ISR and the detector.
+// ISR_ADC_BUFFER_SPSC is a lock-free ring in which the ISR only writes the
+// index in and the detector only writes the index out, so the detector never
+// has to disable interrupts. When it is full the ISR drops the new value and
+// counts it instead of taking the oldest one from the detector's side. The
+// ring is its own module, adcRing.c, which also builds and is stress tested
+// on a host
+#define ISR_ADC_BUFFER_LOCKED 0
+#define ISR_ADC_BUFFER_SPSC 1
+#define ISR_ADC_BUFFER_COMPACT 2
+#define ISR_ADC_BUFFER_MODE ISR_ADC_BUFFER_LOCKED
+
+// ISR_ADC_BUFFER_COMPACT is the locked buffer with 16-bit slots, which hold
+// the 12-bit ADC values, and 2^COMPACT_ADC_BUFFER_SIZE_BITS of them so the
+// indices wrap with a mask instead of a division. The default of 2^16 slots
+// is 0.65 s of samples in 128 KB, against 1 s in 400 KB
+#define COMPACT_ADC_BUFFER_SIZE_BITS 16
+#define COMPACT_ADC_BUFFER_SIZE (1UL << COMPACT_ADC_BUFFER_SIZE_BITS)
+#define COMPACT_ADC_BUFFER_MASK (COMPACT_ADC_BUFFER_SIZE - 1)
+
+// only the selected buffer takes its full size, the others keep one slot
+#define UNUSED_ADC_BUFFER_SIZE 1
+#if ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_LOCKED
+#define LOCKED_ADC_BUFFER_SIZE ADC_BUFFER_SIZE
+#else
+#define LOCKED_ADC_BUFFER_SIZE UNUSED_ADC_BUFFER_SIZE
+#endif
+#if ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC
+#define SPSC_ADC_BUFFER_SIZE ADC_BUFFER_SIZE
+#else
+#define SPSC_ADC_BUFFER_SIZE UNUSED_ADC_BUFFER_SIZE
+#endif
+#if ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT
+#define COMPACT_ADC_BUFFER_STORAGE_SIZE COMPACT_ADC_BUFFER_SIZE
+#else
+#define COMPACT_ADC_BUFFER_STORAGE_SIZE UNUSED_ADC_BUFFER_SIZE
+#endif
+
 #define INDEX_IN_INITIAL_VALUE 0
 #define INDEX_OUT_INITIAL_VALUE 0
 #define ELEMENT_COUNT_INITIAL_VALUE 0
+#define DROP_COUNT_INITIAL_VALUE 0
+#define DROP_COUNT_INCREMENT 1
 #define INDEX_OUT_OFFSET 1
 #define INDEX_IN_OFFSET 1
 
@@ -41,7 +86,8 @@ volatile typedef struct {
   uint32_t indexIn;               // New values go here.
   uint32_t indexOut;              // Pull old values from here.
   uint32_t elementCount;          // Number of elements in the buffer.
-  uint32_t data[ADC_BUFFER_SIZE]; // Values are stored here.
+  uint32_t dropCount;             // Oldest values lost to a full buffer.
+  uint32_t data[LOCKED_ADC_BUFFER_SIZE]; // Values are stored here.
 } adcBuffer_t;
 
 // index Out refers to the index corresponding to the oldest value in the queue
@@ -56,6 +102,25 @@ volatile typedef struct {
 // This is the instantiation of adcBuffer.
 volatile static adcBuffer_t adcBuffer;
 
+// Lock-free single producer, single consumer version of adcBuffer_t. The ISR
+// is the producer and the detector the consumer.
+static uint32_t spscAdcBufferData[SPSC_ADC_BUFFER_SIZE]
+    __attribute__((aligned(ADC_RING_CACHE_LINE_SIZE)));
+static adcRing_t spscAdcBuffer;
+
+// Compact version of adcBuffer_t. The indices count every value ever added
+// and removed and are only masked to find a slot, so the element count is
+// their difference and needs no update of its own. They wrap at 2^32, which
+// is a multiple of the size, so the mask stays right across the wrap.
+volatile typedef struct {
+  uint32_t indexIn;   // number of values added
+  uint32_t indexOut;  // number of values removed
+  uint32_t dropCount; // oldest values lost because the buffer was full
+  uint16_t data[COMPACT_ADC_BUFFER_STORAGE_SIZE];
+} compactAdcBuffer_t;
+
+volatile static compactAdcBuffer_t compactAdcBuffer;
+
 void adcBufferInit();
 
 // returns whether the adc Queue is empty
@@ -64,6 +129,22 @@ bool adcQueueIsEmpty();
 // our test function for the adc Queue
 void adcTest();
 
+// the ADC buffer functions of the locked buffer, which the isr_ functions
+// call unless the lock-free ring was selected
+static void lockedAdcBufferAdd(uint32_t adcData);
+static uint32_t lockedAdcBufferRemove();
+static uint32_t lockedAdcBufferRemoveBlock(uint32_t destination[],
+                                           uint32_t maxCount);
+static uint32_t lockedAdcBufferElementCount();
+
+// the same functions for the compact buffer, which like the locked one needs
+// interrupts disabled around the detector's calls
+static void compactAdcBufferAdd(uint32_t adcData);
+static uint32_t compactAdcBufferRemove();
+static uint32_t compactAdcBufferRemoveBlock(uint32_t destination[],
+                                            uint32_t maxCount);
+static uint32_t compactAdcBufferElementCount();
+
 // Performs inits for anything in isr.c
 void isr_init() {
   transmitter_init();
@@ -72,11 +153,14 @@ void isr_init() {
   lockoutTimer_init();
   hitLedTimer_init();
   trigger_init();
+  inputSampler_init();
   adcBufferInit();
 }
 
 // This function is invoked by the timer interrupt at 100 kHz.
 void isr_function() {
+  // samples the switches, buttons and trigger pin for everything below
+  inputSampler_tick();
   transmitter_tick();
   lockoutTimer_tick();
   hitLedTimer_tick();
@@ -86,13 +170,98 @@ void isr_function() {
 
 // This adds data to the ADC queue. Data are removed from this queue and used by
 // the detector.
-// owerwrite push
 void isr_addDataToAdcBuffer(uint32_t adcData) {
+  // case the lock-free ring was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC) {
+    adcRing_add(&spscAdcBuffer, adcData);
+  }
+  // case the compact buffer was selected
+  else if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT) {
+    compactAdcBufferAdd(adcData);
+  } else {
+    lockedAdcBufferAdd(adcData);
+  }
+}
+
+// This removes a value from the ADC buffer.
+// this removes the oldest value from the buffer,
+// which corresponds to the indexOut variable.
+// if there is no data in the queue, this function
+// returns zero, and does nothing else
+uint32_t isr_removeDataFromAdcBuffer() {
+  // case the lock-free ring was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC) {
+    uint32_t oldData = ADC_QUEUE_EMPTY_RETURN;
+    adcRing_removeBlock(&spscAdcBuffer, &oldData, INDEX_OUT_OFFSET);
+    return oldData;
+  }
+  // case the compact buffer was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT) {
+    return compactAdcBufferRemove();
+  }
+  return lockedAdcBufferRemove();
+}
+
+// Removes up to maxCount of the oldest values from the ADC buffer into
+// destination, oldest first, and returns how many were removed. The values
+// are copied in at most two moves, one on each side of the wraparound. Like
+// isr_removeDataFromAdcBuffer it does not mask interrupts itself, so a caller
+// that has them enabled wraps the whole call in one critical section.
+uint32_t isr_removeBlockFromAdcBuffer(uint32_t destination[],
+                                      uint32_t maxCount) {
+  // case the lock-free ring was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC) {
+    return adcRing_removeBlock(&spscAdcBuffer, destination, maxCount);
+  }
+  // case the compact buffer was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT) {
+    return compactAdcBufferRemoveBlock(destination, maxCount);
+  }
+  return lockedAdcBufferRemoveBlock(destination, maxCount);
+}
+
+// This returns the number of values in the ADC buffer.
+uint32_t isr_adcBufferElementCount() {
+  // case the lock-free ring was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC) {
+    return adcRing_elementCount(&spscAdcBuffer);
+  }
+  // case the compact buffer was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT) {
+    return compactAdcBufferElementCount();
+  }
+  return lockedAdcBufferElementCount();
+}
+
+// Returns true if the ADC buffer can be used by the detector without
+// disabling interrupts.
+bool isr_adcBufferIsLockFree() {
+  return (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC);
+}
+
+// Returns how many ADC values were lost because the selected buffer was
+// full. The lock-free ring drops the new value, the others the oldest one.
+uint32_t isr_getAdcDropCount() {
+  // case the lock-free ring was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_SPSC) {
+    return adcRing_getDropCount(&spscAdcBuffer);
+  }
+  // case the compact buffer was selected
+  if (ISR_ADC_BUFFER_MODE == ISR_ADC_BUFFER_COMPACT) {
+    return compactAdcBuffer.dropCount;
+  }
+  return adcBuffer.dropCount;
+}
+
+// adds data to the locked buffer
+// owerwrite push
+static void lockedAdcBufferAdd(uint32_t adcData) {
   // case the queue is full, so we call the removeDataFromAdcBuffer function
   // before we go on to add the new adc data
-  if (((adcBuffer.indexIn + INDEX_IN_OFFSET) % ADC_BUFFER_SIZE) ==
+  if (((adcBuffer.indexIn + INDEX_IN_OFFSET) % LOCKED_ADC_BUFFER_SIZE) ==
       adcBuffer.indexOut) {
-    isr_removeDataFromAdcBuffer();
+    lockedAdcBufferRemove();
+    adcBuffer.dropCount = adcBuffer.dropCount + DROP_COUNT_INCREMENT;
   }
   // we write adcData to indexIn, which will later be incremented to one past
   // this current location
@@ -103,15 +272,15 @@ void isr_addDataToAdcBuffer(uint32_t adcData) {
 
   // updates indexIn to be one past its original location with also a
   // wraparound check
-  adcBuffer.indexIn = (adcBuffer.indexIn + INDEX_IN_OFFSET) % ADC_BUFFER_SIZE;
+  adcBuffer.indexIn =
+      (adcBuffer.indexIn + INDEX_IN_OFFSET) % LOCKED_ADC_BUFFER_SIZE;
 }
 
-// This removes a value from the ADC buffer.
-// this removes the oldest value from the buffer,
+// removes the oldest value from the locked buffer
 // which corresponds to the indexOut variable.
 // if there is no data in the queue, this function
 // returns zero, and does nothing else
-uint32_t isr_removeDataFromAdcBuffer() {
+static uint32_t lockedAdcBufferRemove() {
   // case the adcQueue is empty, and we return zero and
   // we do nothing else
   if (adcQueueIsEmpty()) {
@@ -129,15 +298,108 @@ uint32_t isr_removeDataFromAdcBuffer() {
     adcBuffer.data[adcBuffer.indexOut] = POPPED_REPLACEMENT;
     // increments index Out taking into account the wraparound
     adcBuffer.indexOut =
-        (adcBuffer.indexOut + INDEX_OUT_OFFSET) % ADC_BUFFER_SIZE;
+        (adcBuffer.indexOut + INDEX_OUT_OFFSET) % LOCKED_ADC_BUFFER_SIZE;
     // decrements the number of elements in the queue by 1
     (adcBuffer.elementCount)--;
     return oldData;
   }
 }
 
-// This returns the number of values in the ADC buffer.
-uint32_t isr_adcBufferElementCount() { return adcBuffer.elementCount; }
+// removes up to maxCount of the oldest values from the locked buffer
+static uint32_t lockedAdcBufferRemoveBlock(uint32_t destination[],
+                                           uint32_t maxCount) {
+  // reads the indices once, so the copy below works on one consistent view of
+  // the buffer
+  uint32_t indexOut = adcBuffer.indexOut;
+  uint32_t count = adcBuffer.elementCount;
+  // case there are fewer values than asked for
+  if (count > maxCount) {
+    count = maxCount;
+  }
+  // values between indexOut and the end of the data array, then the rest from
+  // the start of it
+  uint32_t firstCount = LOCKED_ADC_BUFFER_SIZE - indexOut;
+  if (firstCount > count) {
+    firstCount = count;
+  }
+  // the removed slots are not zeroed here. The ISR writes them again before
+  // they are read, so zeroing them would only cost a second pass
+  memcpy(destination, (const uint32_t *)&adcBuffer.data[indexOut],
+         firstCount * sizeof(uint32_t));
+  memcpy(&destination[firstCount], (const uint32_t *)adcBuffer.data,
+         (count - firstCount) * sizeof(uint32_t));
+
+  indexOut = indexOut + count;
+  // case the copy went past the end of the data array
+  if (indexOut >= LOCKED_ADC_BUFFER_SIZE) {
+    indexOut = indexOut - LOCKED_ADC_BUFFER_SIZE;
+  }
+  adcBuffer.indexOut = indexOut;
+  adcBuffer.elementCount = adcBuffer.elementCount - count;
+  return count;
+}
+
+// returns the number of values in the locked buffer
+static uint32_t lockedAdcBufferElementCount() { return adcBuffer.elementCount; }
+
+// adds data to the compact buffer
+// owerwrite push
+static void compactAdcBufferAdd(uint32_t adcData) {
+  // case the buffer is full, so the oldest value is dropped
+  if (compactAdcBuffer.indexIn - compactAdcBuffer.indexOut >=
+      COMPACT_ADC_BUFFER_SIZE) {
+    compactAdcBuffer.indexOut = compactAdcBuffer.indexOut + INDEX_OUT_OFFSET;
+    compactAdcBuffer.dropCount =
+        compactAdcBuffer.dropCount + DROP_COUNT_INCREMENT;
+  }
+  compactAdcBuffer.data[compactAdcBuffer.indexIn & COMPACT_ADC_BUFFER_MASK] =
+      adcData;
+  compactAdcBuffer.indexIn = compactAdcBuffer.indexIn + INDEX_IN_OFFSET;
+}
+
+// removes the oldest value from the compact buffer. The slot is left as it
+// is, since it is written again before it is read
+static uint32_t compactAdcBufferRemove() {
+  // case the buffer is empty
+  if (compactAdcBuffer.indexIn == compactAdcBuffer.indexOut) {
+    return ADC_QUEUE_EMPTY_RETURN;
+  }
+  uint32_t oldData =
+      compactAdcBuffer.data[compactAdcBuffer.indexOut & COMPACT_ADC_BUFFER_MASK];
+  compactAdcBuffer.indexOut = compactAdcBuffer.indexOut + INDEX_OUT_OFFSET;
+  return oldData;
+}
+
+// removes up to maxCount of the oldest values from the compact buffer
+static uint32_t compactAdcBufferRemoveBlock(uint32_t destination[],
+                                            uint32_t maxCount) {
+  uint32_t indexOut = compactAdcBuffer.indexOut;
+  uint32_t count = compactAdcBuffer.indexIn - indexOut;
+  // case there are fewer values than asked for
+  if (count > maxCount) {
+    count = maxCount;
+  }
+  // the values are widened as they are copied, so the two moves are loops
+  // rather than memcpy calls
+  uint32_t start = indexOut & COMPACT_ADC_BUFFER_MASK;
+  uint32_t firstCount = COMPACT_ADC_BUFFER_SIZE - start;
+  if (firstCount > count) {
+    firstCount = count;
+  }
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < firstCount; i++) {
+    destination[i] = compactAdcBuffer.data[start + i];
+  }
+  for (uint32_t i = firstCount; i < count; i++) {
+    destination[i] = compactAdcBuffer.data[i - firstCount];
+  }
+  compactAdcBuffer.indexOut = indexOut + count;
+  return count;
+}
+
+// returns the number of values in the compact buffer
+static uint32_t compactAdcBufferElementCount() {
+  return compactAdcBuffer.indexIn - compactAdcBuffer.indexOut;
+}
 
 // initializes the ADC Buffer
 void adcBufferInit() {
@@ -147,9 +409,18 @@ void adcBufferInit() {
   adcBuffer.indexIn = INDEX_IN_INITIAL_VALUE;
   // sets number of elements to zero
   adcBuffer.elementCount = ELEMENT_COUNT_INITIAL_VALUE;
+  adcBuffer.dropCount = DROP_COUNT_INITIAL_VALUE;
+  // the lock-free ring is only reset, its slots are written before they are
+  // read
+  adcRing_init(&spscAdcBuffer, spscAdcBufferData, SPSC_ADC_BUFFER_SIZE);
+  // the compact buffer is only reset, its slots are written before they
+  // are read
+  compactAdcBuffer.indexIn = INDEX_IN_INITIAL_VALUE;
+  compactAdcBuffer.indexOut = INDEX_OUT_INITIAL_VALUE;
+  compactAdcBuffer.dropCount = DROP_COUNT_INITIAL_VALUE;
   // iterates through each slot in the data array, and initializes
   // those values to be zero.
-  for (uint32_t i = FOR_LOOP_START_VALUE; i < ADC_BUFFER_SIZE; i++) {
+  for (uint32_t i = FOR_LOOP_START_VALUE; i < LOCKED_ADC_BUFFER_SIZE; i++) {
     adcBuffer.data[i] = BUFFER_INITIAL_VALUE;
   }
 }
@@ -162,6 +433,11 @@ bool adcQueueIsEmpty() { return (adcBuffer.indexOut == adcBuffer.indexIn); }
 
 // our test function for the adc Queue
 void adcTest() {
+  // case another buffer was selected, so the locked one has no slots to show
+  if (ISR_ADC_BUFFER_MODE != ISR_ADC_BUFFER_LOCKED) {
+    printf("adcTest only shows the locked buffer\n");
+    return;
+  }
   adcBufferInit();
   // iterates through 100 different times just to check the performance of the
   // circular queue
@@ -184,4 +460,4 @@ void adcTest() {
   printf("garbage value: %d", adcBuffer.data[adcBuffer.indexIn]);
   printf(" element count: %d", adcBuffer.elementCount);
   printf("\n");
-}
\ No newline at end of file
+}
@@ -0,0 +1,28 @@
+#ifndef ISRMODES_H_
+#define ISRMODES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Entry points of isr.c that are not part of the provided isr.h.
+// These are the faster alternatives to the per-sample functions the detector
+// originally called.
+
+// Removes up to maxCount of the oldest values from the ADC buffer into
+// destination, oldest first, and returns how many were removed. The values
+// are copied in at most two moves, one on each side of the wraparound. Like
+// isr_removeDataFromAdcBuffer it does not mask interrupts itself, so a caller
+// that has them enabled wraps the whole call in one critical section.
+uint32_t isr_removeBlockFromAdcBuffer(uint32_t destination[],
+                                      uint32_t maxCount);
+
+// Returns true if the ADC buffer can be used by the detector without
+// disabling interrupts.
+bool isr_adcBufferIsLockFree();
+
+// Returns how many ADC values were lost because the selected buffer was full
+// since isr_init. The lock-free ring drops the new value, and the locked and
+// compact buffers overwrite the oldest one, but every mode counts the loss.
+uint32_t isr_getAdcDropCount();
+
+#endif /* ISRMODES_H_ */